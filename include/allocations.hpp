@@ -0,0 +1,114 @@
+/*
+ *  Copyright 2016-present Daniel Trugman
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#ifndef BENCHMARK_ALLOCATIONS_HPP
+#define BENCHMARK_ALLOCATIONS_HPP
+
+#include <cstdlib>
+#include <new>
+
+#include "counters.hpp"
+
+// Count the heap allocations of every thread in Counters::current().allocations,
+// which runners then report per iteration. Replaces the global operator new
+// and delete, so it must be expanded once per program, at global scope:
+//
+//     BM_COUNT_ALLOCATIONS()
+//
+// Over-aligned allocations are counted too where the overloads taking a
+// std::align_val_t exist (C++17), e.g. those of std::pmr::new_delete_resource().
+// Allocations fail by throwing std::bad_alloc, without calling a new_handler.
+// The operators are never inlined, which would only let the compiler pair
+// malloc() and free() with operator new and delete, and warn about a mismatch.
+#if defined __GNUC__ || defined __clang__
+#   define BM_NOINLINE __attribute__((noinline))
+#else
+#   define BM_NOINLINE
+#endif
+
+#if defined __cpp_aligned_new
+#   define BM_COUNT_ALIGNED_ALLOCATIONS()                                                                 \
+    BM_NOINLINE void* operator new(std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept \
+    {                                                                                                     \
+        ++::bm::Counters::current().allocations;                                                          \
+        auto align = static_cast<std::size_t>(alignment);                                                 \
+        return std::aligned_alloc(align, ((size ? size : 1) + align - 1) / align * align);               \
+    }                                                                                                     \
+    BM_NOINLINE void* operator new(std::size_t size, std::align_val_t alignment)                          \
+    {                                                                                                     \
+        if (void* memory = ::operator new(size, alignment, std::nothrow)) return memory;                  \
+        throw std::bad_alloc();                                                                           \
+    }                                                                                                     \
+    BM_NOINLINE void* operator new[](std::size_t size, std::align_val_t alignment)                        \
+    {                                                                                                     \
+        return ::operator new(size, alignment);                                                           \
+    }                                                                                                     \
+    BM_NOINLINE void* operator new[](std::size_t size, std::align_val_t alignment,                        \
+                                     const std::nothrow_t& tag) noexcept                                  \
+    {                                                                                                     \
+        return ::operator new(size, alignment, tag);                                                      \
+    }                                                                                                     \
+    BM_NOINLINE void operator delete(void* memory, std::align_val_t) noexcept { std::free(memory); }      \
+    BM_NOINLINE void operator delete[](void* memory, std::align_val_t) noexcept { std::free(memory); }    \
+    BM_NOINLINE void operator delete(void* memory, std::size_t, std::align_val_t) noexcept                \
+    {                                                                                                     \
+        std::free(memory);                                                                                \
+    }                                                                                                     \
+    BM_NOINLINE void operator delete[](void* memory, std::size_t, std::align_val_t) noexcept              \
+    {                                                                                                     \
+        std::free(memory);                                                                                \
+    }                                                                                                     \
+    BM_NOINLINE void operator delete(void* memory, std::align_val_t, const std::nothrow_t&) noexcept      \
+    {                                                                                                     \
+        std::free(memory);                                                                                \
+    }                                                                                                     \
+    BM_NOINLINE void operator delete[](void* memory, std::align_val_t, const std::nothrow_t&) noexcept    \
+    {                                                                                                     \
+        std::free(memory);                                                                                \
+    }
+#else
+#   define BM_COUNT_ALIGNED_ALLOCATIONS()
+#endif
+
+#define BM_COUNT_ALLOCATIONS()                                                                            \
+    BM_NOINLINE void* operator new(std::size_t size)                                                      \
+    {                                                                                                     \
+        ++::bm::Counters::current().allocations;                                                          \
+        if (void* memory = std::malloc(size ? size : 1)) return memory;                                   \
+        throw std::bad_alloc();                                                                           \
+    }                                                                                                     \
+    BM_NOINLINE void* operator new[](std::size_t size)                                                    \
+    {                                                                                                     \
+        return ::operator new(size);                                                                      \
+    }                                                                                                     \
+    BM_NOINLINE void* operator new(std::size_t size, const std::nothrow_t&) noexcept                      \
+    {                                                                                                     \
+        ++::bm::Counters::current().allocations;                                                          \
+        return std::malloc(size ? size : 1);                                                              \
+    }                                                                                                     \
+    BM_NOINLINE void* operator new[](std::size_t size, const std::nothrow_t& tag) noexcept                \
+    {                                                                                                     \
+        return ::operator new(size, tag);                                                                 \
+    }                                                                                                     \
+    BM_NOINLINE void operator delete(void* memory) noexcept { std::free(memory); }                        \
+    BM_NOINLINE void operator delete[](void* memory) noexcept { std::free(memory); }                      \
+    BM_NOINLINE void operator delete(void* memory, std::size_t) noexcept { std::free(memory); }           \
+    BM_NOINLINE void operator delete[](void* memory, std::size_t) noexcept { std::free(memory); }         \
+    BM_NOINLINE void operator delete(void* memory, const std::nothrow_t&) noexcept { std::free(memory); } \
+    BM_NOINLINE void operator delete[](void* memory, const std::nothrow_t&) noexcept { std::free(memory); } \
+    BM_COUNT_ALIGNED_ALLOCATIONS()
+
+#endif // BENCHMARK_ALLOCATIONS_HPP
@@ -0,0 +1,145 @@
+/*
+ *  Copyright 2016-present Daniel Trugman
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#ifndef BENCHMARK_ATOMIC_MARK_HPP
+#define BENCHMARK_ATOMIC_MARK_HPP
+
+#include <algorithm>
+#include <cstdint>
+#include <chrono>
+#include <atomic>
+#include <limits>
+
+#include "mark.hpp"
+
+namespace bm {
+
+// A Mark that writers update with atomic operations only, so they are never
+// blocked, and that a reader can snapshot and reset at any time.
+// Every field is exact, but a sample recorded concurrently with exchange()
+// may have its duration and its iteration counted in adjacent intervals.
+class AtomicMark
+{
+public: // C'tors
+    AtomicMark() :
+        _total(0), _iterations(0),
+        _min((std::numeric_limits<int64_t>::max)()),
+        _max((std::numeric_limits<int64_t>::min)()),
+        _bytes(0), _items(0) {}
+
+    AtomicMark(const AtomicMark&) = delete;
+    AtomicMark& operator=(const AtomicMark&) = delete;
+
+public: // Overloaded operators
+    template < class Rep, class Period >
+    AtomicMark& operator+=(const std::chrono::duration<Rep, Period>& duration)
+    {
+        auto ns = std::chrono::duration_cast<Mark::nanoseconds>(duration).count();
+        return add(1, ns, ns, ns);
+    }
+
+    AtomicMark& operator+=(const Mark& rhs)
+    {
+        if (rhs.iterations() != 0)
+        {
+            add(static_cast<uint64_t>(rhs.iterations()), rhs.as_nanoseconds(),
+                rhs.maximal().as_nanoseconds(), rhs.minimal().as_nanoseconds());
+        }
+        add_bytes(rhs.bytes());
+        add_items(rhs.items());
+        return *this;
+    }
+
+public: // Methods
+    AtomicMark& add_bytes(uint64_t bytes)
+    {
+        _bytes.fetch_add(bytes, std::memory_order_relaxed);
+        return *this;
+    }
+
+    AtomicMark& add_items(uint64_t items)
+    {
+        _items.fetch_add(items, std::memory_order_relaxed);
+        return *this;
+    }
+
+    // The values aggregated so far
+    Mark snapshot() const
+    {
+        return make_mark(_iterations.load(std::memory_order_relaxed),
+                         _total.load(std::memory_order_relaxed),
+                         _max.load(std::memory_order_relaxed),
+                         _min.load(std::memory_order_relaxed),
+                         _bytes.load(std::memory_order_relaxed),
+                         _items.load(std::memory_order_relaxed));
+    }
+
+    // The values aggregated since the previous exchange, resetting them
+    Mark exchange()
+    {
+        return make_mark(_iterations.exchange(0, std::memory_order_relaxed),
+                         _total.exchange(0, std::memory_order_relaxed),
+                         _max.exchange((std::numeric_limits<int64_t>::min)(), std::memory_order_relaxed),
+                         _min.exchange((std::numeric_limits<int64_t>::max)(), std::memory_order_relaxed),
+                         _bytes.exchange(0, std::memory_order_relaxed),
+                         _items.exchange(0, std::memory_order_relaxed));
+    }
+
+private: // Methods
+    AtomicMark& add(uint64_t iterations, int64_t total, int64_t max, int64_t min)
+    {
+        _total.fetch_add(total, std::memory_order_relaxed);
+        _iterations.fetch_add(iterations, std::memory_order_relaxed);
+
+        auto current = _max.load(std::memory_order_relaxed);
+        while (max > current && !_max.compare_exchange_weak(current, max, std::memory_order_relaxed)) {}
+
+        current = _min.load(std::memory_order_relaxed);
+        while (min < current && !_min.compare_exchange_weak(current, min, std::memory_order_relaxed)) {}
+
+        return *this;
+    }
+
+    static Mark make_mark(uint64_t iterations, int64_t total, int64_t max, int64_t min,
+                          uint64_t bytes, uint64_t items)
+    {
+        Mark mark;
+        if (iterations != 0)
+        {
+            // A sample may be half way in, with its extremes not yet visible
+            if (max < min)
+            {
+                max = min = total / static_cast<int64_t>(iterations);
+            }
+            mark.add(iterations, Mark::nanoseconds(total), Mark::nanoseconds(max), Mark::nanoseconds(min));
+        }
+        mark.add_bytes(bytes);
+        mark.add_items(items);
+        return mark;
+    }
+
+private: // Members
+    std::atomic<int64_t>  _total;
+    std::atomic<uint64_t> _iterations;
+    std::atomic<int64_t>  _min;
+    std::atomic<int64_t>  _max;
+    std::atomic<uint64_t> _bytes;
+    std::atomic<uint64_t> _items;
+};
+
+} // namespace bm
+
+#endif // BENCHMARK_ATOMIC_MARK_HPP
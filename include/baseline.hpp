@@ -0,0 +1,320 @@
+/*
+ *  Copyright 2016-present Daniel Trugman
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#ifndef BENCHMARK_BASELINE_HPP
+#define BENCHMARK_BASELINE_HPP
+
+#include <iostream>
+#include <fstream>
+#include <iomanip>
+#include <limits>
+#include <string>
+#include <vector>
+#include <map>
+
+#include "json.hpp"
+#include "runner.hpp"
+#include "statistics.hpp"
+
+namespace bm {
+
+// Suite results are saved as JSON:
+// {
+//   "version": 1,
+//   "results": [
+//     {
+//       "name": "sort", "args": [1024], "threads": 1, "batches": 20,
+//       "iterations": 4096, "total_ns": 1000000, "min_ns": 230, "max_ns": 270,
+//       "bytes": 0, "items": 4096,
+//       "histogram": [[bucket, count], ...],
+//       "samples": [244.1, 243.9, ...]
+//     }
+//   ]
+// }
+static const int baseline_version = 1;
+
+inline void write_baseline(std::ostream& out, const std::vector<Result>& results)
+{
+    auto precision = out.precision(std::numeric_limits<double>::max_digits10);
+
+    out << "{\n  \"version\": " << baseline_version << ",\n  \"results\": [";
+    for (size_t i = 0; i < results.size(); ++i)
+    {
+        const auto& result = results[i];
+        out << (i ? "," : "") << "\n    {"
+            << "\n      \"name\": " << Json::escape(result.name) << ","
+            << "\n      \"args\": [";
+        for (size_t j = 0; j < result.args.size(); ++j)
+        {
+            out << (j ? ", " : "") << result.args[j];
+        }
+        out << "],"
+            << "\n      \"threads\": " << result.threads << ","
+            << "\n      \"batches\": " << result.batches << ","
+            << "\n      \"iterations\": " << result.mark.iterations() << ","
+            << "\n      \"total_ns\": " << result.mark.as_nanoseconds() << ","
+            << "\n      \"min_ns\": " << result.mark.minimal().as_nanoseconds() << ","
+            << "\n      \"max_ns\": " << result.mark.maximal().as_nanoseconds() << ","
+            << "\n      \"bytes\": " << result.mark.bytes() << ","
+            << "\n      \"items\": " << result.mark.items() << ","
+            << "\n      \"histogram\": [";
+        bool first = true;
+        for (size_t bucket = 0; bucket < Histogram::buckets; ++bucket)
+        {
+            if (result.histogram.bucket(bucket) == 0) continue;
+
+            out << (first ? "" : ", ") << "[" << bucket << ", " << result.histogram.bucket(bucket) << "]";
+            first = false;
+        }
+        out << "],"
+            << "\n      \"samples\": [";
+        for (size_t j = 0; j < result.samples.size(); ++j)
+        {
+            out << (j ? ", " : "") << result.samples[j];
+        }
+        out << "]\n    }";
+    }
+    out << "\n  ]\n}\n";
+
+    out.precision(precision);
+}
+
+// Returns false on a malformed or incompatible baseline
+inline bool read_baseline(std::istream& in, std::vector<Result>& results)
+{
+    Json root;
+    if (!Json::parse(in, root)) return false;
+    if (root["version"].as_number() != baseline_version) return false;
+    if (root["results"].type() != Json::Type::array) return false;
+
+    results.clear();
+    for (const auto& entry : root["results"].as_array())
+    {
+        Result result;
+        result.name    = entry["name"].as_string();
+        result.threads = static_cast<unsigned>(entry["threads"].as_number());
+        result.batches = static_cast<uint64_t>(entry["batches"].as_number());
+
+        for (const auto& arg : entry["args"].as_array())
+        {
+            result.args.push_back(static_cast<int64_t>(arg.as_number()));
+        }
+
+        auto iterations = static_cast<uint64_t>(entry["iterations"].as_number());
+        if (iterations != 0)
+        {
+            result.mark.add(iterations,
+                            Mark::nanoseconds(static_cast<int64_t>(entry["total_ns"].as_number())),
+                            Mark::nanoseconds(static_cast<int64_t>(entry["max_ns"].as_number())),
+                            Mark::nanoseconds(static_cast<int64_t>(entry["min_ns"].as_number())));
+        }
+        result.mark.add_bytes(static_cast<uint64_t>(entry["bytes"].as_number()));
+        result.mark.add_items(static_cast<uint64_t>(entry["items"].as_number()));
+
+        for (const auto& bucket : entry["histogram"].as_array())
+        {
+            const auto& pair = bucket.as_array();
+            if (pair.size() != 2) return false;
+
+            result.histogram.add_bucket(static_cast<size_t>(pair[0].as_number()),
+                                        static_cast<uint64_t>(pair[1].as_number()));
+        }
+
+        for (const auto& sample : entry["samples"].as_array())
+        {
+            result.samples.push_back(sample.as_number());
+        }
+
+        results.push_back(std::move(result));
+    }
+    return true;
+}
+
+inline bool save_baseline(const std::string& path, const std::vector<Result>& results)
+{
+    std::ofstream fout(path, std::ios::binary);
+    if (!fout) return false;
+
+    write_baseline(fout, results);
+    return static_cast<bool>(fout);
+}
+
+inline bool load_baseline(const std::string& path, std::vector<Result>& results)
+{
+    std::ifstream fin(path, std::ios::binary);
+    if (!fin) return false;
+
+    return read_baseline(fin, results);
+}
+
+struct RegressionOptions
+{
+    RegressionOptions() : threshold(0.05), alpha(0.05) {}
+
+    double threshold; // Relative change of the mean that is tolerated, e.g. 5%
+    double alpha;     // Significance level of the change
+};
+
+struct Regression
+{
+    enum class Verdict { unchanged, improved, regressed, added, missing };
+
+    Regression() : baseline(0), current(0), change(0), p_value(1), verdict(Verdict::unchanged) {}
+
+    std::string id;
+    double      baseline; // Mean nanoseconds per iteration
+    double      current;
+    double      change;   // Relative change of the mean, positive is slower
+    double      p_value;
+    Verdict     verdict;
+};
+
+inline const char* to_string(Regression::Verdict verdict)
+{
+    switch (verdict)
+    {
+        case Regression::Verdict::unchanged: return "unchanged";
+        case Regression::Verdict::improved:  return "improved";
+        case Regression::Verdict::regressed: return "REGRESSED";
+        case Regression::Verdict::added:     return "added";
+        case Regression::Verdict::missing:   return "MISSING";
+    }
+    return "unknown";
+}
+
+inline std::ostream& operator<<(std::ostream& out, const Regression& regression)
+{
+    out << regression.id << ": " << to_string(regression.verdict);
+    if (regression.verdict == Regression::Verdict::missing)
+    {
+        out << " (" << regression.baseline << "ns, not in this run)";
+    }
+    else if (regression.verdict != Regression::Verdict::added)
+    {
+        out << " (" << regression.baseline << "ns -> " << regression.current << "ns, "
+            << std::showpos << regression.change * 100 << std::noshowpos << "%, "
+            << "p = " << regression.p_value << ")";
+    }
+    return out;
+}
+
+inline double mean_of(const Result& result)
+{
+    auto iterations = result.mark.iterations();
+    return (iterations == 0) ? 0 : static_cast<double>(result.mark.as_nanoseconds()) / iterations;
+}
+
+// Compare every current result against the baseline result with the same id.
+// A change is flagged only if it exceeds the threshold and is statistically
+// significant according to a Mann-Whitney U test of the batch samples.
+// Without samples to test, the threshold alone decides.
+// Baseline results that are not in the current run follow, marked missing.
+inline std::vector<Regression> detect_regressions(const std::vector<Result>& baseline,
+                                                  const std::vector<Result>& current,
+                                                  const RegressionOptions& opts = RegressionOptions())
+{
+    std::map<std::string, const Result*> previous;
+    for (const auto& result : baseline)
+    {
+        previous[id(result)] = &result;
+    }
+
+    std::vector<Regression> regressions;
+    std::map<std::string, bool> seen;
+    for (const auto& result : current)
+    {
+        Regression regression;
+        regression.id = id(result);
+        regression.current = mean_of(result);
+
+        auto it = previous.find(regression.id);
+        if (it == previous.end())
+        {
+            regression.verdict = Regression::Verdict::added;
+            regressions.push_back(regression);
+            continue;
+        }
+
+        seen[regression.id] = true;
+
+        const auto& before = *it->second;
+        regression.baseline = mean_of(before);
+        regression.change = (regression.baseline == 0) ? 0 : regression.current / regression.baseline - 1;
+
+        if (before.samples.size() >= 2 && result.samples.size() >= 2)
+        {
+            regression.p_value = stats::mann_whitney_test(before.samples, result.samples).p_value;
+        }
+        else
+        {
+            regression.p_value = 0;
+        }
+
+        if (regression.p_value < opts.alpha)
+        {
+            if (regression.change > opts.threshold)
+            {
+                regression.verdict = Regression::Verdict::regressed;
+            }
+            else if (regression.change < -opts.threshold)
+            {
+                regression.verdict = Regression::Verdict::improved;
+            }
+        }
+
+        regressions.push_back(regression);
+    }
+
+    for (const auto& before : baseline)
+    {
+        Regression regression;
+        regression.id = id(before);
+        if (seen[regression.id]) continue;
+
+        seen[regression.id] = true;
+        regression.baseline = mean_of(before);
+        regression.verdict = Regression::Verdict::missing;
+        regressions.push_back(regression);
+    }
+    return regressions;
+}
+
+// The number of results that had a baseline to be compared against
+inline size_t compared(const std::vector<Regression>& regressions)
+{
+    size_t count = 0;
+    for (const auto& regression : regressions)
+    {
+        if (regression.verdict != Regression::Verdict::added &&
+            regression.verdict != Regression::Verdict::missing) ++count;
+    }
+    return count;
+}
+
+// A process exit code, non-zero if anything regressed or nothing was compared.
+// Missing results alone don't fail, so filtered runs can use a full baseline.
+inline int exit_code(const std::vector<Regression>& regressions)
+{
+    for (const auto& regression : regressions)
+    {
+        if (regression.verdict == Regression::Verdict::regressed) return 1;
+    }
+    return (compared(regressions) == 0) ? 1 : 0;
+}
+
+} // namespace bm
+
+#endif // BENCHMARK_BASELINE_HPP
@@ -19,13 +19,30 @@
 
 #include <type_traits>
 #include <iostream>
+#include <utility>
 #include <chrono>
+#include <cstdint>
+#include <future>
+#include <atomic>
+#include <memory>
 
 #include "mark.hpp"
+#include "sync_mark.hpp"
+#include "atomic_mark.hpp"
 #include "thread_clock.hpp"
+#include "process_clock.hpp"
 
 namespace bm {
 
+template < class T >
+struct is_future : std::false_type {};
+
+template < class T >
+struct is_future<std::future<T>> : std::true_type {};
+
+template < class T >
+struct is_future<std::shared_future<T>> : std::true_type {};
+
 template < class Clock >
 class GenericBench
 {
@@ -40,30 +57,111 @@ public:
     GenericBench() = delete;
 
 public:
-    class Probe
+    // Probes record into a Mark, or any sink with the same interface,
+    // e.g. an AtomicMark that is periodically reported
+    template < class Sink >
+    class BasicProbe
     {
     public:
-        Probe(Mark & mark) :
-            _done(false), _mark(mark), _start(Clock::now()) {}
-        ~Probe() { done(); }
+        BasicProbe(Sink & mark) :
+            _state(state::running), _mark(mark), _origin(Clock::now()), _lap(0) {}
+        ~BasicProbe() { done(); }
+
+        // Stop accumulating active time, e.g. while blocking on a lock or I/O
+        void pause()
+        {
+            if (_state != state::running) return;
+
+            _origin = timepoint(Clock::now() - _origin);
+            _state = state::paused;
+        }
+
+        void resume()
+        {
+            if (_state != state::paused) return;
+
+            _origin = Clock::now() - _origin.time_since_epoch();
+            _state = state::running;
+        }
+
+        // Record the active time since the previous lap (or construction)
+        template < class Lap >
+        void lap(Lap & mark)
+        {
+            if (_state == state::done) return;
+
+            auto active = elapsed();
+            mark += (active - _lap);
+            _lap = active;
+        }
+
+        // Account for data processed within the probe's scope
+        void bytes(uint64_t count) { _mark.add_bytes(count); }
+        void items(uint64_t count) { _mark.add_items(count); }
 
         void done()
         {
-            if (_done) return;
+            if (_state == state::done) return;
 
-            _done = true;
-            _stop = Clock::now();
-            _mark += (_stop - _start);
+            _mark += elapsed();
+            _state = state::done;
         }
 
     private:
         using timepoint = typename Clock::time_point;
+        using duration  = typename Clock::duration;
+
+        enum class state : uint8_t { running, paused, done };
+
+    private:
+        // While running, _origin is shifted forward by the paused time, so
+        // the active time is always (now - _origin). While paused, it holds
+        // the active time itself, measured from the clock's epoch.
+        duration elapsed() const
+        {
+            return (_state == state::running) ? Clock::now() - _origin
+                                              : _origin.time_since_epoch();
+        }
 
     private:
-        bool      _done;
-        Mark &    _mark;
-        timepoint _start;
-        timepoint _stop;
+        state     _state;
+        Sink &    _mark;
+        timepoint _origin;
+        duration  _lap;
+    };
+
+    using Probe       = BasicProbe<Mark>;
+    using AtomicProbe = BasicProbe<AtomicMark>;
+
+    // Handed to asynchronous operations, to be invoked upon their completion.
+    // Records the time since the operation started into the SyncMark, once,
+    // from whichever thread invokes it. The SyncMark must outlive it.
+    class Completion
+    {
+    public:
+        Completion(SyncMark & mark) :
+            _state(std::make_shared<state>(mark)) {}
+
+        void operator()() const
+        {
+            if (_state->fired.exchange(true)) return;
+
+            _state->mark += (Clock::now() - _state->start);
+        }
+
+    private:
+        struct state
+        {
+            state(SyncMark & mark) :
+                mark(mark), start(Clock::now()), fired(false) {}
+
+            SyncMark &                   mark;
+            typename Clock::time_point   start;
+            std::atomic<bool>            fired;
+        };
+
+    private:
+        std::shared_ptr<state> _state;
     };
 
 public:
@@ -89,6 +187,42 @@ public:
         auto mark = Mark(after - before);
         return std::make_pair(mark, result);
     }
+
+    // Time func(args...) until the future it returns is ready.
+    // The (ready) future is returned along with the Mark.
+    template < class Func, class... Args >
+    static auto mark_async(Func&& func, Args&&... args)
+        -> enable_if_type< is_future<result_type<Func&&(Args&&...)>>::value,
+                           std::pair<Mark, result_type<Func&&(Args&&...)>> >
+    {
+        assert_shared_clock();
+
+        auto before = Clock::now();
+        auto future = std::forward<Func>(func)(std::forward<Args>(args)...);
+        future.wait();
+        auto after = Clock::now();
+        return std::make_pair(Mark(after - before), std::move(future));
+    }
+
+    // Call func(completion, args...) and time it until it invokes the completion,
+    // possibly later on and from another thread. The result is added to the mark.
+    template < class Func, class... Args >
+    static void mark_async(SyncMark& mark, Func&& func, Args&&... args)
+    {
+        assert_shared_clock();
+
+        Completion completion(mark);
+        std::forward<Func>(func)(completion, std::forward<Args>(args)...);
+    }
+
+private:
+    static void assert_shared_clock()
+    {
+#ifdef BENCHMARK_THREAD_CPUTIME
+        static_assert(!std::is_same<Clock, thread_clock>::value,
+                      "Asynchronous operations complete on other threads, use a shared clock");
+#endif // BENCHMARK_THREAD_CPUTIME
+    }
 };
 
 using Bench = GenericBench<std::chrono::steady_clock>;
@@ -97,6 +231,10 @@ using Bench = GenericBench<std::chrono::steady_clock>;
     using Thread = GenericBench<thread_clock>;
 #endif // BENCHMARK_THREAD_CPUTIME
 
+#ifdef BENCHMARK_PROCESS_CPUTIME
+    using Process = GenericBench<process_clock>;
+#endif // BENCHMARK_PROCESS_CPUTIME
+
 } // namespaces
 
 #endif // BENCHMARK_BENCHMARK_HPP
@@ -0,0 +1,379 @@
+/*
+ *  Copyright 2016-present Daniel Trugman
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#ifndef BENCHMARK_BOOTSTRAP_HPP
+#define BENCHMARK_BOOTSTRAP_HPP
+
+#include <algorithm>
+#include <iostream>
+#include <numeric>
+#include <cstdint>
+#include <vector>
+#include <thread>
+#include <random>
+#include <cmath>
+
+#include "random.hpp"
+#include "statistics.hpp"
+
+namespace bm {
+namespace stats {
+
+// Statistics for bootstrap(), which may reorder the samples they are given
+
+struct Mean
+{
+    double operator()(std::vector<double>& samples) const { return mean(samples); }
+};
+
+// The q-quantile (0-1), interpolated like quantile() but without a full sort
+struct Quantile
+{
+    double operator()(std::vector<double>& samples) const
+    {
+        if (samples.empty()) return 0;
+
+        auto position = (std::min)((std::max)(q, 0.0), 1.0) * (samples.size() - 1);
+        auto lower = static_cast<size_t>(position);
+        std::nth_element(samples.begin(), samples.begin() + lower, samples.end());
+        auto value = samples[lower];
+        if (lower + 1 >= samples.size()) return value;
+
+        auto next = *std::min_element(samples.begin() + lower + 1, samples.end());
+        return value + (position - lower) * (next - value);
+    }
+
+    // The same, of count sorted values, where at(rank) is the value of a rank
+    template < class At >
+    double of_sorted(size_t count, At at) const
+    {
+        if (count == 0) return 0;
+
+        auto position = (std::min)((std::max)(q, 0.0), 1.0) * (count - 1);
+        auto lower = static_cast<size_t>(position);
+        auto value = at(lower);
+        if (lower + 1 >= count) return value;
+
+        return value + (position - lower) * (at(lower + 1) - value);
+    }
+
+    double q;
+};
+
+struct BootstrapOptions
+{
+    BootstrapOptions() :
+        resamples(2000),
+        confidence(0.95),
+        threads((std::max)(std::thread::hardware_concurrency(), 1u)),
+        seed(0x5eed),
+        max_jackknife(500) {}
+
+    size_t   resamples;
+    double   confidence;
+    unsigned threads;       // Resamples are split among them
+    uint64_t seed;          // Equal seeds and thread counts give equal intervals
+    size_t   max_jackknife; // Beyond this many samples, the jackknife leaves out groups of samples
+};
+
+// A point estimate and its confidence interval
+struct Estimate
+{
+    Estimate() : value(0), lower(0), upper(0) {}
+
+    double value;
+    double lower;
+    double upper;
+};
+
+inline std::ostream& operator<<(std::ostream& out, const Estimate& estimate)
+{
+    out << estimate.value << " [" << estimate.lower << ", " << estimate.upper << "]";
+    return out;
+}
+
+namespace detail {
+
+// Call work(begin, end, index) for about equal parts of [0, count) on separate threads
+template < class Work >
+void parallel_for(size_t count, unsigned threads, Work work)
+{
+    size_t parts = (std::max)(threads, 1u);
+    parts = (std::min)(parts, (std::max)(count, static_cast<size_t>(1)));
+    if (parts == 1)
+    {
+        work(static_cast<size_t>(0), count, 0u);
+        return;
+    }
+
+    std::vector<std::thread> workers;
+    for (size_t i = 0; i < parts; ++i)
+    {
+        workers.emplace_back(work, count * i / parts, count * (i + 1) / parts, static_cast<unsigned>(i));
+    }
+    for (auto& worker : workers)
+    {
+        worker.join();
+    }
+}
+
+// The values at increasing ranks of a resample, i.e. of as many values drawn
+// with replacement from the sorted samples, without drawing them one by one.
+// How many of the draws fall below an index is binomially distributed, so
+// halving the range of indices finds the index of a rank in O(log n) draws.
+// Later ranks continue from there, one index at a time.
+class ResampledRanks
+{
+public:
+    ResampledRanks(const std::vector<double>& sorted, Xoshiro256& engine) :
+        _sorted(sorted), _engine(engine), _index(0), _before(0), _count(0), _descended(false) {}
+
+    double operator()(size_t rank)
+    {
+        if (!_descended) descend(rank);
+        while (rank >= _before + _count) next();
+        return _sorted[_index];
+    }
+
+private:
+    uint64_t binomial(uint64_t trials, double p)
+    {
+        std::binomial_distribution<uint64_t> distribution(trials, p);
+        return distribution(_engine);
+    }
+
+    void descend(size_t rank)
+    {
+        size_t   lo = 0, hi = _sorted.size();
+        uint64_t draws = _sorted.size();
+        while (hi - lo > 1)
+        {
+            auto mid = lo + (hi - lo) / 2;
+            auto left = binomial(draws, static_cast<double>(mid - lo) / (hi - lo));
+            if (_before + left > rank)
+            {
+                hi = mid;
+                draws = left;
+            }
+            else
+            {
+                _before += left;
+                draws -= left;
+                lo = mid;
+            }
+        }
+
+        _index = lo;
+        _count = draws;
+        _descended = true;
+    }
+
+    // The draws above the current index spread evenly over the indices above it
+    void next()
+    {
+        auto after = _sorted.size() - _before - _count;
+        _before += _count;
+        ++_index;
+        _count = binomial(after, 1.0 / (_sorted.size() - _index));
+    }
+
+private:
+    const std::vector<double>& _sorted;
+    Xoshiro256&                _engine;
+    size_t                     _index;     // The current index into the sorted samples
+    uint64_t                   _before;    // Draws below it
+    uint64_t                   _count;     // Draws at it
+    bool                       _descended;
+};
+
+// The BCa interval around value, from the bootstrap replicates and the jackknife estimates
+inline Estimate bca(double value, std::vector<double>& replicates,
+                    const std::vector<double>& jackknife, const BootstrapOptions& opts)
+{
+    Estimate estimate;
+    estimate.value = value;
+
+    // Bias correction, from the share of replicates below the estimate
+    double below = 0;
+    for (auto replicate : replicates)
+    {
+        below += (replicate < value) ? 1 : (replicate == value) ? 0.5 : 0;
+    }
+    auto half = 0.5 / replicates.size();
+    auto z0 = normal_quantile((std::min)((std::max)(below / replicates.size(), half), 1 - half));
+
+    // Acceleration, from the skewness of the jackknife estimates
+    auto center = mean(jackknife);
+    double squares = 0, cubes = 0;
+    for (auto leftover : jackknife)
+    {
+        auto d = center - leftover;
+        squares += d * d;
+        cubes   += d * d * d;
+    }
+    auto a = (squares > 0) ? cubes / (6 * std::pow(squares, 1.5)) : 0;
+
+    auto adjusted = [z0, a](double z) {
+        return normal_cdf(z0 + (z0 + z) / (1 - a * (z0 + z)));
+    };
+
+    auto z = normal_quantile(0.5 + opts.confidence / 2);
+    estimate.lower = quantile(replicates, adjusted(-z));
+    estimate.upper = quantile(replicates, adjusted(z));
+    return estimate;
+}
+
+} // namespace detail
+
+// A bias-corrected and accelerated (BCa) bootstrap confidence interval of
+// statistic(samples). Resampling is parallelized, with every thread drawing
+// from its own xoshiro256** subsequence. The acceleration is estimated by a
+// jackknife, which leaves out strided groups of samples when there are many.
+template < class Statistic >
+Estimate bootstrap(const std::vector<double>& samples, Statistic statistic,
+                   const BootstrapOptions& opts = BootstrapOptions())
+{
+    Estimate estimate;
+    if (samples.empty()) return estimate;
+
+    auto copy = samples;
+    estimate.value = statistic(copy);
+    estimate.lower = estimate.upper = estimate.value;
+    if (samples.size() < 2 || opts.resamples == 0) return estimate;
+
+    auto n = samples.size();
+    std::vector<double> replicates(opts.resamples);
+    detail::parallel_for(opts.resamples, opts.threads, [&](size_t begin, size_t end, unsigned index) {
+        Xoshiro256 engine(opts.seed);
+        for (unsigned i = 0; i < index; ++i) engine.jump();
+
+        std::vector<double> resample(n);
+        for (auto b = begin; b < end; ++b)
+        {
+            for (auto& value : resample)
+            {
+                value = samples[bounded(engine, static_cast<uint32_t>(n))];
+            }
+            replicates[b] = statistic(resample);
+        }
+    });
+
+    // The jackknife estimates, for the acceleration
+    auto groups = (std::min)(n, (std::max)(opts.max_jackknife, static_cast<size_t>(2)));
+    std::vector<double> jackknife(groups);
+    detail::parallel_for(groups, opts.threads, [&](size_t begin, size_t end, unsigned) {
+        std::vector<double> rest;
+        rest.reserve(n);
+        for (auto group = begin; group < end; ++group)
+        {
+            rest.clear();
+            for (size_t i = 0; i < n; ++i)
+            {
+                if (i % groups != group) rest.push_back(samples[i]);
+            }
+            jackknife[group] = statistic(rest);
+        }
+    });
+
+    return detail::bca(estimate.value, replicates, jackknife, opts);
+}
+
+// Quantiles are resampled without gathering and selecting: the samples are
+// sorted once, and a resample only draws how many of its values fall at the
+// ranks around the quantile (see detail::ResampledRanks). The quantiles the
+// jackknife leaves groups out of are looked up in the sorted samples too.
+inline Estimate bootstrap(const std::vector<double>& samples, Quantile quantile,
+                          const BootstrapOptions& opts = BootstrapOptions())
+{
+    Estimate estimate;
+    if (samples.empty()) return estimate;
+
+    // The order of the samples is kept for the jackknife
+    auto n = samples.size();
+    std::vector<size_t> order(n);
+    std::iota(order.begin(), order.end(), static_cast<size_t>(0));
+    std::sort(order.begin(), order.end(), [&](size_t a, size_t b) { return samples[a] < samples[b]; });
+
+    std::vector<double> sorted(n);
+    for (size_t rank = 0; rank < n; ++rank) sorted[rank] = samples[order[rank]];
+
+    estimate.value = quantile.of_sorted(n, [&](size_t rank) { return sorted[rank]; });
+    estimate.lower = estimate.upper = estimate.value;
+    if (n < 2 || opts.resamples == 0) return estimate;
+
+    std::vector<double> replicates(opts.resamples);
+    detail::parallel_for(opts.resamples, opts.threads, [&](size_t begin, size_t end, unsigned index) {
+        Xoshiro256 engine(opts.seed);
+        for (unsigned i = 0; i < index; ++i) engine.jump();
+
+        for (auto b = begin; b < end; ++b)
+        {
+            replicates[b] = quantile.of_sorted(n, detail::ResampledRanks(sorted, engine));
+        }
+    });
+
+    // The same strided groups as for any other statistic, whose ranks in the
+    // sorted samples are skipped when looking up the ranks of the rest
+    std::vector<size_t> ranks(n);
+    for (size_t rank = 0; rank < n; ++rank) ranks[order[rank]] = rank;
+
+    auto groups = (std::min)(n, (std::max)(opts.max_jackknife, static_cast<size_t>(2)));
+    std::vector<double> jackknife(groups);
+    std::vector<size_t> removed;
+    for (size_t group = 0; group < groups; ++group)
+    {
+        removed.clear();
+        for (auto i = group; i < n; i += groups) removed.push_back(ranks[i]);
+        std::sort(removed.begin(), removed.end());
+
+        jackknife[group] = quantile.of_sorted(n - removed.size(), [&](size_t rank) {
+            for (auto skipped : removed)
+            {
+                if (skipped > rank) break;
+                ++rank;
+            }
+            return sorted[rank];
+        });
+    }
+
+    return detail::bca(estimate.value, replicates, jackknife, opts);
+}
+
+inline Estimate bootstrap_mean(const std::vector<double>& samples,
+                               const BootstrapOptions& opts = BootstrapOptions())
+{
+    return bootstrap(samples, Mean(), opts);
+}
+
+inline Estimate bootstrap_median(const std::vector<double>& samples,
+                                 const BootstrapOptions& opts = BootstrapOptions())
+{
+    Quantile median = { 0.5 };
+    return bootstrap(samples, median, opts);
+}
+
+// The given percentile (0-100), e.g. 99
+inline Estimate bootstrap_percentile(const std::vector<double>& samples, double percent,
+                                     const BootstrapOptions& opts = BootstrapOptions())
+{
+    Quantile percentile = { percent / 100 };
+    return bootstrap(samples, percentile, opts);
+}
+
+} // namespace stats
+} // namespace bm
+
+#endif // BENCHMARK_BOOTSTRAP_HPP
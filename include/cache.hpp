@@ -0,0 +1,195 @@
+/*
+ *  Copyright 2016-present Daniel Trugman
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#ifndef BENCHMARK_CACHE_HPP
+#define BENCHMARK_CACHE_HPP
+
+#include <algorithm>
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#if defined __linux__
+#   include <sys/types.h>
+#   include <sys/stat.h>
+#   include <unistd.h>
+#   include <fcntl.h>
+#endif
+
+#if (defined __GNUC__ || defined __clang__) && (defined __x86_64__ || defined __i386__)
+#   define BENCHMARK_CLFLUSH
+#   include <emmintrin.h>
+#endif
+
+namespace bm {
+namespace cache {
+
+// Cache geometry in bytes, with conservative defaults where the system won't tell
+struct Sizes
+{
+    size_t line;
+    size_t l1;
+    size_t l2;
+    size_t llc; // The last level, shared by all cores
+};
+
+inline Sizes sizes()
+{
+    Sizes sizes = { 64, 32 << 10, 1 << 20, 32 << 20 };
+#if defined __linux__ && defined _SC_LEVEL1_DCACHE_LINESIZE
+    auto query = [](int name, size_t fallback) {
+        auto value = sysconf(name);
+        return (value > 0) ? static_cast<size_t>(value) : fallback;
+    };
+    sizes.line = query(_SC_LEVEL1_DCACHE_LINESIZE, sizes.line);
+    sizes.l1   = query(_SC_LEVEL1_DCACHE_SIZE, sizes.l1);
+    sizes.l2   = query(_SC_LEVEL2_CACHE_SIZE, sizes.l2);
+    sizes.llc  = query(_SC_LEVEL3_CACHE_SIZE, (std::max)(sizes.l2, sizes.llc));
+#endif
+    return sizes;
+}
+
+// Evicts the CPU caches by reading a buffer larger than the last level cache,
+// one cache line at a time. The walk only reads, so a single evictor may be
+// shared by concurrently running threads.
+class Evictor
+{
+public: // C'tors
+    // A size of 0 means twice the last level cache
+    explicit Evictor(size_t bytes = 0) : _line(sizes().line)
+    {
+        if (bytes == 0) bytes = 2 * sizes().llc;
+
+        // Fill it, so every page is backed by memory of its own
+        _buffer.resize(bytes);
+        for (size_t i = 0; i < _buffer.size(); ++i)
+        {
+            _buffer[i] = static_cast<unsigned char>(i);
+        }
+    }
+
+public: // Getters
+    size_t size() const { return _buffer.size(); }
+
+public: // Methods
+    void operator()() const
+    {
+        unsigned sum = 0;
+        for (size_t i = 0; i < _buffer.size(); i += _line)
+        {
+            sum += _buffer[i];
+        }
+        sink() = sum;
+    }
+
+private: // Helpers
+    static volatile unsigned& sink()
+    {
+        static volatile unsigned value = 0;
+        return value;
+    }
+
+private: // Members
+    std::vector<unsigned char> _buffer;
+    size_t                     _line;
+};
+
+// The evictor used by cold runs that don't provide their own
+inline const Evictor& default_evictor()
+{
+    static const Evictor evictor;
+    return evictor;
+}
+
+// Flush the cache lines of a region from every level of the hierarchy.
+// Returns false where that isn't supported, i.e. off x86.
+inline bool flush(const void* data, size_t bytes)
+{
+#ifdef BENCHMARK_CLFLUSH
+    static const size_t line = sizes().line;
+
+    auto begin = reinterpret_cast<uintptr_t>(data) & ~static_cast<uintptr_t>(line - 1);
+    auto end = reinterpret_cast<uintptr_t>(data) + bytes;
+    for (auto address = begin; address < end; address += line)
+    {
+        _mm_clflush(reinterpret_cast<const void*>(address));
+    }
+    _mm_mfence();
+    return true;
+#else
+    (void)data;
+    (void)bytes;
+    return false;
+#endif
+}
+
+template < class T >
+bool flush(const std::vector<T>& values)
+{
+    return flush(values.data(), values.size() * sizeof(T));
+}
+
+// Whether drop_page_cache() is permitted, without dropping anything
+inline bool can_drop_page_cache()
+{
+#if defined __linux__
+    return access("/proc/sys/vm/drop_caches", W_OK) == 0;
+#else
+    return false;
+#endif
+}
+
+// Drop the clean pages of the whole page cache, after writing back the dirty
+// ones. Requires root, returns false if not permitted.
+inline bool drop_page_cache()
+{
+#if defined __linux__
+    sync();
+
+    auto fd = open("/proc/sys/vm/drop_caches", O_WRONLY);
+    if (fd < 0) return false;
+
+    auto written = write(fd, "1", 1);
+    close(fd);
+    return written == 1;
+#else
+    return false;
+#endif
+}
+
+// Drop the cached pages of a single file, which needs no privileges.
+// Returns false if the file can't be opened or the kernel won't advise.
+inline bool drop_page_cache(const std::string& path)
+{
+#if defined __linux__
+    auto fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+
+    auto dropped = fdatasync(fd) == 0 &&
+                   posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED) == 0;
+    close(fd);
+    return dropped;
+#else
+    (void)path;
+    return false;
+#endif
+}
+
+} // namespace cache
+} // namespace bm
+
+#endif // BENCHMARK_CACHE_HPP
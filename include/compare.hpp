@@ -0,0 +1,161 @@
+/*
+ *  Copyright 2016-present Daniel Trugman
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#ifndef BENCHMARK_COMPARE_HPP
+#define BENCHMARK_COMPARE_HPP
+
+#include <algorithm>
+#include <iostream>
+#include <cstdint>
+#include <vector>
+#include <chrono>
+#include <cmath>
+
+#include "mark.hpp"
+#include "runner.hpp"
+#include "statistics.hpp"
+
+namespace bm {
+
+struct CompareOptions
+{
+    enum class Test { mann_whitney, welch };
+
+    CompareOptions() :
+        batch_time(std::chrono::milliseconds(1)),
+        samples(30),
+        confidence(0.95),
+        alpha(0.05),
+        test(Test::mann_whitney) {}
+
+    Mark::nanoseconds batch_time; // Target duration of a single timed batch
+    size_t            samples;    // Number of batches collected per callable
+    double            confidence; // Confidence level of the speedup interval
+    double            alpha;      // Significance level
+    Test              test;
+};
+
+struct Comparison
+{
+    Comparison() : speedup(1), lower(1), upper(1), p_value(1), alpha(0.05) {}
+
+    // Per-iteration nanoseconds of every batch
+    std::vector<double> a;
+    std::vector<double> b;
+
+    double speedup; // Time of A divided by time of B, above 1 means B is faster
+    double lower;   // Confidence interval of the speedup
+    double upper;
+    double p_value;
+    double alpha;
+
+    bool significant() const { return p_value < alpha; }
+};
+
+inline std::ostream& operator<<(std::ostream& out, const Comparison& comparison)
+{
+    out << "A: " << stats::mean(comparison.a) << "ns, "
+        << "B: " << stats::mean(comparison.b) << "ns per iteration, "
+        << "speedup " << comparison.speedup
+        << " [" << comparison.lower << ", " << comparison.upper << "], "
+        << "p = " << comparison.p_value
+        << (comparison.significant() ? " (significant)" : " (not significant)");
+    return out;
+}
+
+namespace detail {
+
+template < class Clock, class Func >
+double time_batch(Func& func, size_t iterations)
+{
+    auto before = Clock::now();
+    for (size_t i = 0; i < iterations; ++i)
+    {
+        invoke(func);
+    }
+    auto after = Clock::now();
+
+    auto ns = std::chrono::duration_cast<Mark::nanoseconds>(after - before).count();
+    return static_cast<double>(ns) / iterations;
+}
+
+template < class Clock, class Func >
+size_t calibrate_batch(Func& func, const CompareOptions& opts)
+{
+    // Warm up, then grow the batch until it lasts long enough
+    size_t iterations = 1;
+    time_batch<Clock>(func, iterations);
+    while (time_batch<Clock>(func, iterations) * iterations < opts.batch_time.count() &&
+           iterations < (static_cast<size_t>(1) << 30))
+    {
+        iterations *= 2;
+    }
+    return iterations;
+}
+
+} // namespace detail
+
+// Time both callables in interleaved batches (ABBA order) to cancel out
+// drift, e.g. frequency scaling or a noisy neighbour, and test whether
+// the difference between them is statistically significant.
+template < class Clock = std::chrono::steady_clock, class FuncA, class FuncB >
+Comparison compare(FuncA&& a, FuncB&& b, const CompareOptions& opts = CompareOptions())
+{
+    auto batch_a = detail::calibrate_batch<Clock>(a, opts);
+    auto batch_b = detail::calibrate_batch<Clock>(b, opts);
+
+    Comparison result;
+    result.alpha = opts.alpha;
+    result.a.reserve(opts.samples);
+    result.b.reserve(opts.samples);
+
+    for (size_t i = 0; i < opts.samples; ++i)
+    {
+        if (i % 2 == 0)
+        {
+            result.a.push_back(detail::time_batch<Clock>(a, batch_a));
+            result.b.push_back(detail::time_batch<Clock>(b, batch_b));
+        }
+        else
+        {
+            result.b.push_back(detail::time_batch<Clock>(b, batch_b));
+            result.a.push_back(detail::time_batch<Clock>(a, batch_a));
+        }
+    }
+
+    auto test = (opts.test == CompareOptions::Test::welch)
+        ? stats::welch_test(result.a, result.b)
+        : stats::mann_whitney_test(result.a, result.b);
+    result.p_value = test.p_value;
+
+    // Delta method on the log of the ratio of means
+    auto mean_a = stats::mean(result.a);
+    auto mean_b = stats::mean(result.b);
+    if (mean_a <= 0 || mean_b <= 0) return result;
+
+    result.speedup = mean_a / mean_b;
+
+    auto error = std::sqrt(stats::variance(result.a) / (result.a.size() * mean_a * mean_a) +
+                           stats::variance(result.b) / (result.b.size() * mean_b * mean_b));
+    auto z = stats::normal_quantile(0.5 + opts.confidence / 2);
+    result.lower = result.speedup * std::exp(-z * error);
+    result.upper = result.speedup * std::exp( z * error);
+    return result;
+}
+
+} // namespace bm
+
+#endif // BENCHMARK_COMPARE_HPP
@@ -0,0 +1,138 @@
+/*
+ *  Copyright 2016-present Daniel Trugman
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#ifndef BENCHMARK_COMPLEXITY_HPP
+#define BENCHMARK_COMPLEXITY_HPP
+
+#include <iostream>
+#include <utility>
+#include <vector>
+#include <cmath>
+
+namespace bm {
+
+enum class Complexity
+{
+    constant,     // O(1)
+    logarithmic,  // O(log n)
+    linear,       // O(n)
+    linearithmic, // O(n log n)
+    quadratic,    // O(n^2)
+};
+
+inline const char* to_string(Complexity complexity)
+{
+    switch (complexity)
+    {
+        case Complexity::constant:     return "O(1)";
+        case Complexity::logarithmic:  return "O(log n)";
+        case Complexity::linear:       return "O(n)";
+        case Complexity::linearithmic: return "O(n log n)";
+        case Complexity::quadratic:    return "O(n^2)";
+    }
+    return "O(?)";
+}
+
+inline double evaluate(Complexity complexity, double n)
+{
+    switch (complexity)
+    {
+        case Complexity::constant:     return 1.0;
+        case Complexity::logarithmic:  return std::log2(n);
+        case Complexity::linear:       return n;
+        case Complexity::linearithmic: return n * std::log2(n);
+        case Complexity::quadratic:    return n * n;
+    }
+    return 1.0;
+}
+
+// The result of fitting time(n) = coefficient * f(n)
+struct Fit
+{
+    Fit() : complexity(Complexity::constant), coefficient(0), rms(0) {}
+
+    Complexity complexity;
+    double     coefficient;
+    double     rms;         // Root mean square error, relative to the mean time
+};
+
+inline std::ostream& operator<<(std::ostream& out, const Fit& fit)
+{
+    out << to_string(fit.complexity) << " (coefficient " << fit.coefficient
+        << ", RMS " << fit.rms * 100 << "%)";
+    return out;
+}
+
+// Least squares fit of (n, time) samples to a specific complexity
+inline Fit fit(const std::vector<std::pair<double, double>>& samples, Complexity complexity)
+{
+    Fit result;
+    result.complexity = complexity;
+    if (samples.empty()) return result;
+
+    double fx_fx = 0;
+    double fx_y  = 0;
+    double y_sum = 0;
+    for (const auto& sample : samples)
+    {
+        auto fx = evaluate(complexity, sample.first);
+        fx_fx += fx * fx;
+        fx_y  += fx * sample.second;
+        y_sum += sample.second;
+    }
+
+    result.coefficient = (fx_fx == 0) ? 0 : fx_y / fx_fx;
+
+    double error = 0;
+    for (const auto& sample : samples)
+    {
+        auto diff = sample.second - result.coefficient * evaluate(complexity, sample.first);
+        error += diff * diff;
+    }
+
+    auto mean = y_sum / samples.size();
+    auto rms = std::sqrt(error / samples.size());
+    result.rms = (mean == 0) ? rms : rms / mean;
+    return result;
+}
+
+// Least squares fit of (n, time) samples to the complexity with the lowest error.
+// Simpler complexities win ties.
+inline Fit fit(const std::vector<std::pair<double, double>>& samples)
+{
+    static const Complexity candidates[] = {
+        Complexity::constant,
+        Complexity::logarithmic,
+        Complexity::linear,
+        Complexity::linearithmic,
+        Complexity::quadratic,
+    };
+
+    Fit best = fit(samples, candidates[0]);
+    for (auto complexity : candidates)
+    {
+        auto current = fit(samples, complexity);
+        if (current.rms < best.rms)
+        {
+            best = current;
+        }
+    }
+    return best;
+}
+
+} // namespace bm
+
+#endif // BENCHMARK_COMPLEXITY_HPP
@@ -0,0 +1,133 @@
+/*
+ *  Copyright 2016-present Daniel Trugman
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#ifndef BENCHMARK_CONTEXT_HPP
+#define BENCHMARK_CONTEXT_HPP
+
+#include <fstream>
+#include <cstdlib>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <chrono>
+#include <ctime>
+
+#if defined __linux__ || defined __APPLE__
+#   include <unistd.h>
+#endif
+
+// The flags this translation unit was compiled with, defined by the build system.
+// Suites report those the benchmarks registered with instead, see registry.hpp.
+#ifndef BENCHMARK_CXX_FLAGS
+#   define BENCHMARK_CXX_FLAGS "unknown"
+#endif
+
+namespace bm {
+
+// The host a suite runs on, to tell apart results of different machines and builds
+struct Context
+{
+    Context() : cores(0), mhz(0) {}
+
+    std::string date;     // ISO 8601, UTC
+    std::string host;
+    std::string cpu;      // Model name
+    unsigned    cores;
+    double      mhz;      // Current frequency of the first core, 0 if unknown
+    std::string scaling;  // Frequency scaling governor, e.g. "performance"
+    std::string compiler;
+    std::string flags;
+    std::string clock;    // steady_clock, thread_clock or process_clock
+
+    static Context gather(const std::string& clock)
+    {
+        Context context;
+        context.clock    = clock;
+        context.cores    = std::thread::hardware_concurrency();
+        context.compiler = compiler_name();
+        context.flags    = BENCHMARK_CXX_FLAGS;
+        context.scaling  = "unknown";
+
+        auto now = std::chrono::system_clock::to_time_t(std::chrono::system_clock::now());
+        char date[32] = {};
+        std::strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%SZ", std::gmtime(&now));
+        context.date = date;
+
+#if defined __linux__ || defined __APPLE__
+        char host[256] = {};
+        if (gethostname(host, sizeof(host) - 1) == 0)
+        {
+            context.host = host;
+        }
+#endif
+
+#if defined __linux__
+        std::ifstream cpuinfo("/proc/cpuinfo");
+        std::string line;
+        while (std::getline(cpuinfo, line))
+        {
+            auto colon = line.find(':');
+            if (colon == std::string::npos) continue;
+
+            auto value = line.substr(colon + 1);
+            value.erase(0, value.find_first_not_of(" \t"));
+
+            if (context.cpu.empty() && line.compare(0, 10, "model name") == 0)
+            {
+                context.cpu = value;
+            }
+            else if (context.mhz == 0 && line.compare(0, 7, "cpu MHz") == 0)
+            {
+                context.mhz = std::strtod(value.c_str(), nullptr);
+            }
+        }
+
+        static const std::string cpufreq("/sys/devices/system/cpu/cpu0/cpufreq/");
+        std::ifstream governor(cpufreq + "scaling_governor");
+        if (governor >> line)
+        {
+            context.scaling = line;
+        }
+
+        std::ifstream frequency(cpufreq + "scaling_cur_freq");
+        double khz = 0;
+        if (frequency >> khz)
+        {
+            context.mhz = khz / 1000;
+        }
+#endif
+        return context;
+    }
+
+    static std::string compiler_name()
+    {
+        std::ostringstream out;
+#if defined __clang__
+        out << "clang " << __clang_major__ << "." << __clang_minor__ << "." << __clang_patchlevel__;
+#elif defined __GNUC__
+        out << "gcc " << __GNUC__ << "." << __GNUC_MINOR__ << "." << __GNUC_PATCHLEVEL__;
+#elif defined _MSC_VER
+        out << "msvc " << _MSC_VER;
+#else
+        out << "unknown";
+#endif
+        return out.str();
+    }
+};
+
+} // namespace bm
+
+#endif // BENCHMARK_CONTEXT_HPP
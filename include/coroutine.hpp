@@ -0,0 +1,180 @@
+/*
+ *  Copyright 2016-present Daniel Trugman
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#ifndef BENCHMARK_COROUTINE_HPP
+#define BENCHMARK_COROUTINE_HPP
+
+// Coroutine probes require C++20, the rest of the library does not
+#if defined(__cpp_impl_coroutine) && __cpp_impl_coroutine >= 201902L
+#   define BENCHMARK_COROUTINES
+#endif
+
+#ifdef BENCHMARK_COROUTINES
+
+#include <coroutine>
+#include <type_traits>
+#include <utility>
+#include <chrono>
+
+#include "mark.hpp"
+
+namespace bm {
+
+// Measures the scope of a coroutine twice: the total (wall) time, and the
+// active time, which excludes the time spent suspended in awaits that are
+// routed through the probe, i.e. co_await probe(awaitable).
+// Other suspension points, e.g. those of the promise, are counted as active.
+template < class Clock >
+class GenericCoroutineProbe
+{
+public:
+    template < class Awaiter >
+    class Timed;
+
+public:
+    GenericCoroutineProbe(Mark & active, Mark & total) :
+        _active_mark(active), _total_mark(total),
+        _start(Clock::now()), _resumed(_start), _active(0),
+        _running(true), _done(false) {}
+    ~GenericCoroutineProbe() { done(); }
+
+    GenericCoroutineProbe(const GenericCoroutineProbe&) = delete;
+    GenericCoroutineProbe& operator=(const GenericCoroutineProbe&) = delete;
+
+    // Wrap an awaitable, so the coroutine is not timed while suspended on it
+    template < class Awaitable >
+    auto operator()(Awaitable&& awaitable)
+    {
+        // Awaiters given as lvalues are referenced, temporaries are moved in
+        using awaiter = std::conditional_t<
+            std::is_rvalue_reference_v<decltype(awaiter_of(std::forward<Awaitable>(awaitable)))>,
+            std::remove_cvref_t<decltype(awaiter_of(std::forward<Awaitable>(awaitable)))>,
+            decltype(awaiter_of(std::forward<Awaitable>(awaitable)))>;
+        return Timed<awaiter>(*this, awaiter_of(std::forward<Awaitable>(awaitable)));
+    }
+
+    void done()
+    {
+        if (_done) return;
+
+        auto now = Clock::now();
+        pause(now);
+        _active_mark += _active;
+        _total_mark  += (now - _start);
+        _done = true;
+    }
+
+private:
+    using timepoint = typename Clock::time_point;
+    using duration  = typename Clock::duration;
+
+private:
+    template < class Awaitable >
+    static decltype(auto) awaiter_of(Awaitable&& awaitable)
+    {
+        if constexpr (requires { std::forward<Awaitable>(awaitable).operator co_await(); })
+        {
+            return std::forward<Awaitable>(awaitable).operator co_await();
+        }
+        else if constexpr (requires { operator co_await(std::forward<Awaitable>(awaitable)); })
+        {
+            return operator co_await(std::forward<Awaitable>(awaitable));
+        }
+        else
+        {
+            return std::forward<Awaitable>(awaitable);
+        }
+    }
+
+    void pause(timepoint now = Clock::now())
+    {
+        if (!_running) return;
+
+        _active += (now - _resumed);
+        _running = false;
+    }
+
+    void resume()
+    {
+        if (_running || _done) return;
+
+        _resumed = Clock::now();
+        _running = true;
+    }
+
+private:
+    Mark &    _active_mark;
+    Mark &    _total_mark;
+    timepoint _start;
+    timepoint _resumed;
+    duration  _active;
+    bool      _running;
+    bool      _done;
+};
+
+template < class Clock >
+template < class Awaiter >
+class GenericCoroutineProbe<Clock>::Timed
+{
+public:
+    Timed(GenericCoroutineProbe & probe, Awaiter awaiter) :
+        _probe(probe), _awaiter(std::forward<Awaiter>(awaiter)) {}
+
+    bool await_ready()
+    {
+        return _awaiter.await_ready();
+    }
+
+    // The coroutine may be resumed on another thread before the wrapped
+    // await_suspend returns, so the probe is only touched before it.
+    template < class Promise >
+    auto await_suspend(std::coroutine_handle<Promise> handle)
+    {
+        using result = decltype(_awaiter.await_suspend(handle));
+
+        _probe.pause();
+        if constexpr (std::is_same_v<result, bool>)
+        {
+            if (_awaiter.await_suspend(handle)) return true;
+
+            _probe.resume(); // Did not suspend after all
+            return false;
+        }
+        else
+        {
+            return _awaiter.await_suspend(handle);
+        }
+    }
+
+    decltype(auto) await_resume()
+    {
+        _probe.resume();
+        return _awaiter.await_resume();
+    }
+
+private:
+    GenericCoroutineProbe & _probe;
+    Awaiter                 _awaiter;
+};
+
+// A steady clock keeps counting when a coroutine is resumed on another thread
+using CoroutineProbe = GenericCoroutineProbe<std::chrono::steady_clock>;
+
+} // namespace bm
+
+#endif // BENCHMARK_COROUTINES
+
+#endif // BENCHMARK_COROUTINE_HPP
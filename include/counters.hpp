@@ -0,0 +1,46 @@
+/*
+ *  Copyright 2016-present Daniel Trugman
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#ifndef BENCHMARK_COUNTERS_HPP
+#define BENCHMARK_COUNTERS_HPP
+
+#include <cstdint>
+
+namespace bm {
+
+// Data processed by the running benchmark, counted per thread.
+// The runner attributes whatever was counted within its timed regions
+// to the result's Mark, to compute bytes/sec and items/sec.
+// Allocations are only counted with BM_COUNT_ALLOCATIONS, see allocations.hpp.
+struct Counters
+{
+    uint64_t bytes;
+    uint64_t items;
+    uint64_t allocations;
+
+    static Counters& current()
+    {
+        static thread_local Counters counters = { 0, 0, 0 };
+        return counters;
+    }
+};
+
+inline void processed_bytes(uint64_t bytes) { Counters::current().bytes += bytes; }
+inline void processed_items(uint64_t items) { Counters::current().items += items; }
+
+} // namespace bm
+
+#endif // BENCHMARK_COUNTERS_HPP
@@ -0,0 +1,244 @@
+/*
+ *  Copyright 2016-present Daniel Trugman
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#ifndef BENCHMARK_HISTOGRAM_HPP
+#define BENCHMARK_HISTOGRAM_HPP
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+#include <chrono>
+#include <limits>
+#include <cmath>
+
+#include "simd.hpp"
+
+namespace bm {
+
+// A log-linear histogram of nanosecond durations.
+// Values below 64ns are counted exactly, larger ones fall into 32 equally
+// sized sub-buckets per power of two, i.e. a relative error of up to ~3%.
+class Histogram
+{
+public: // Types
+    using nanoseconds = std::chrono::nanoseconds;
+
+public: // Constants
+    static const unsigned sub_bucket_bits = 5;
+    static const size_t   sub_buckets     = static_cast<size_t>(1) << sub_bucket_bits;
+    static const size_t   linear_buckets  = 2 * sub_buckets;
+    static const size_t   buckets         = linear_buckets + (62 - sub_bucket_bits) * sub_buckets;
+
+public: // C'tors
+    Histogram() : _counts(buckets, 0)
+    {
+        clear();
+    }
+
+public: // Overloaded operators
+    template < class Rep, class Period >
+    Histogram& operator+=(const std::chrono::duration<Rep, Period>& duration)
+    {
+        return add(std::chrono::duration_cast<nanoseconds>(duration).count());
+    }
+
+    Histogram& operator+=(const Histogram& rhs)
+    {
+        for (size_t i = 0; i < buckets; ++i)
+        {
+            _counts[i] += rhs._counts[i];
+        }
+        _count  += rhs._count;
+        _sum    += rhs._sum;
+        _sum_sq += rhs._sum_sq;
+        _min = (std::min)(_min, rhs._min);
+        _max = (std::max)(_max, rhs._max);
+        return *this;
+    }
+
+public: // Getters
+    uint64_t count() const { return _count; }
+    int64_t  minimal() const { return _min; }
+    int64_t  maximal() const { return _max; }
+
+    double mean() const
+    {
+        return (_count == 0) ? 0 : _sum / _count;
+    }
+
+    double stddev() const
+    {
+        if (_count < 2) return 0;
+
+        auto m = mean();
+        auto variance = (_sum_sq - _count * m * m) / (_count - 1);
+        return (variance <= 0) ? 0 : std::sqrt(variance);
+    }
+
+    // The value below which the given percentage (0-100) of the values fall
+    int64_t percentile(double percent) const
+    {
+        if (_count == 0) return 0;
+
+        auto rank = static_cast<uint64_t>(std::ceil(percent / 100 * _count));
+        rank = (std::max)(rank, static_cast<uint64_t>(1));
+
+        uint64_t seen = 0;
+        for (size_t i = 0; i < buckets; ++i)
+        {
+            seen += _counts[i];
+            if (seen >= rank)
+            {
+                return (std::min)((std::max)(midpoint(i), _min), _max);
+            }
+        }
+        return _max;
+    }
+
+    uint64_t bucket(size_t index) const { return _counts[index]; }
+
+public: // Methods
+    Histogram& add(int64_t ns, uint64_t count = 1)
+    {
+        if (count == 0) return *this;
+
+        ns = (std::max)(ns, static_cast<int64_t>(0));
+        _counts[index_of(ns)] += count;
+        _count  += count;
+        _sum    += static_cast<double>(ns) * count;
+        _sum_sq += static_cast<double>(ns) * ns * count;
+        _min = (std::min)(_min, ns);
+        _max = (std::max)(_max, ns);
+        return *this;
+    }
+
+    // Add many values at once. Sum, min and max are vectorized per block,
+    // which falls back to add() if it holds negative values or might overflow.
+    Histogram& add_bulk(const int64_t* ns, size_t n)
+    {
+        static const size_t  block = 4096;
+        static const int64_t limit = (std::numeric_limits<int64_t>::max)() / block;
+
+        for (size_t offset = 0; offset < n; offset += block)
+        {
+            auto count = (std::min)(n - offset, block);
+            const auto* values = ns + offset;
+            auto summary = simd::summarize(values, count);
+
+            if (summary.min < 0 || summary.max > limit)
+            {
+                for (size_t i = 0; i < count; ++i) add(values[i]);
+                continue;
+            }
+
+            double sum_sq = 0;
+            for (size_t i = 0; i < count; ++i)
+            {
+                ++_counts[index_of(values[i])];
+                sum_sq += static_cast<double>(values[i]) * values[i];
+            }
+
+            _count  += count;
+            _sum    += static_cast<double>(summary.sum);
+            _sum_sq += sum_sq;
+            _min = (std::min)(_min, summary.min);
+            _max = (std::max)(_max, summary.max);
+        }
+        return *this;
+    }
+
+    // Coordinated omission correction, in the style of HdrHistogram: a value
+    // recorded by a closed loop that expected a new value every interval,
+    // also stands for the values that would have been recorded while it
+    // stalled the loop, i.e. ns - interval, ns - 2 * interval, ...
+    Histogram& add_corrected(int64_t ns, int64_t interval)
+    {
+        add(ns);
+        if (interval <= 0) return *this;
+
+        for (auto missing = ns - interval; missing >= interval; missing -= interval)
+        {
+            add(missing);
+        }
+        return *this;
+    }
+
+    // Restore a bucket of a saved histogram, counted at its midpoint
+    Histogram& add_bucket(size_t index, uint64_t count)
+    {
+        if (index >= buckets) return *this;
+        return add(midpoint(index), count);
+    }
+
+    void clear()
+    {
+        std::fill(_counts.begin(), _counts.end(), 0);
+        _count  = 0;
+        _sum    = 0;
+        _sum_sq = 0;
+        _min = (std::numeric_limits<int64_t>::max)();
+        _max = 0;
+    }
+
+public: // Bucket math
+    static size_t index_of(int64_t ns)
+    {
+        auto value = static_cast<uint64_t>(ns);
+        if (value < linear_buckets) return static_cast<size_t>(value);
+
+#if defined __GNUC__ || defined __clang__
+        auto magnitude = static_cast<unsigned>(63 - __builtin_clzll(value));
+#else
+        unsigned magnitude = 63;
+        while (!(value >> magnitude)) --magnitude;
+#endif
+
+        auto shift = magnitude - sub_bucket_bits;
+        return linear_buckets +
+               (magnitude - sub_bucket_bits - 1) * sub_buckets +
+               static_cast<size_t>((value >> shift) - sub_buckets);
+    }
+
+    static int64_t lower_bound(size_t index)
+    {
+        if (index < linear_buckets) return static_cast<int64_t>(index);
+
+        auto offset = index - linear_buckets;
+        auto shift = offset / sub_buckets + 1;
+        auto sub = offset % sub_buckets + sub_buckets;
+        return static_cast<int64_t>(static_cast<uint64_t>(sub) << shift);
+    }
+
+    static int64_t midpoint(size_t index)
+    {
+        if (index < linear_buckets) return static_cast<int64_t>(index);
+
+        auto shift = (index - linear_buckets) / sub_buckets + 1;
+        return lower_bound(index) + static_cast<int64_t>((static_cast<uint64_t>(1) << shift) / 2);
+    }
+
+private: // Members
+    std::vector<uint64_t> _counts;
+    uint64_t              _count;
+    double                _sum;
+    double                _sum_sq;
+    int64_t               _min;
+    int64_t               _max;
+};
+
+} // namespace bm
+
+#endif // BENCHMARK_HISTOGRAM_HPP
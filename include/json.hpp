@@ -0,0 +1,281 @@
+/*
+ *  Copyright 2016-present Daniel Trugman
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#ifndef BENCHMARK_JSON_HPP
+#define BENCHMARK_JSON_HPP
+
+#include <iostream>
+#include <iterator>
+#include <cstdlib>
+#include <cstdio>
+#include <string>
+#include <vector>
+#include <map>
+
+namespace bm {
+
+// Just enough JSON for reading and writing the files this library produces
+class Json
+{
+public: // Types
+    enum class Type { null, boolean, number, string, array, object };
+
+    using array_type  = std::vector<Json>;
+    using object_type = std::map<std::string, Json>;
+
+public: // C'tors
+    Json() : _type(Type::null), _boolean(false), _number(0) {}
+
+public: // Getters
+    Type type() const { return _type; }
+
+    bool               as_boolean() const { return _boolean; }
+    double             as_number()  const { return _number; }
+    const std::string& as_string()  const { return _string; }
+    const array_type&  as_array()   const { return _array; }
+    const object_type& as_object()  const { return _object; }
+
+    // Member lookup, a null value if missing
+    const Json& operator[](const std::string& key) const
+    {
+        static const Json missing;
+        auto it = _object.find(key);
+        return (it == _object.end()) ? missing : it->second;
+    }
+
+public: // Parsing
+    // Returns false on malformed input
+    static bool parse(const std::string& text, Json& value)
+    {
+        size_t pos = 0;
+        if (!parse_value(text, pos, value)) return false;
+
+        skip_whitespace(text, pos);
+        return pos == text.size();
+    }
+
+    static bool parse(std::istream& in, Json& value)
+    {
+        std::string text((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+        return parse(text, value);
+    }
+
+public: // Writing
+    static std::string escape(const std::string& text)
+    {
+        std::string escaped("\"");
+        for (auto c : text)
+        {
+            switch (c)
+            {
+                case '"':  escaped += "\\\""; break;
+                case '\\': escaped += "\\\\"; break;
+                case '\n': escaped += "\\n";  break;
+                case '\r': escaped += "\\r";  break;
+                case '\t': escaped += "\\t";  break;
+                default:
+                    if (static_cast<unsigned char>(c) < 0x20)
+                    {
+                        char code[8];
+                        std::snprintf(code, sizeof(code), "\\u%04x", c);
+                        escaped += code;
+                    }
+                    else
+                    {
+                        escaped += c;
+                    }
+            }
+        }
+        escaped += '"';
+        return escaped;
+    }
+
+private: // Parsing helpers
+    static void skip_whitespace(const std::string& text, size_t& pos)
+    {
+        while (pos < text.size() &&
+               (text[pos] == ' ' || text[pos] == '\n' || text[pos] == '\r' || text[pos] == '\t'))
+        {
+            ++pos;
+        }
+    }
+
+    static bool consume(const std::string& text, size_t& pos, const char* literal)
+    {
+        for (; *literal; ++literal, ++pos)
+        {
+            if (pos >= text.size() || text[pos] != *literal) return false;
+        }
+        return true;
+    }
+
+    static bool parse_value(const std::string& text, size_t& pos, Json& value)
+    {
+        skip_whitespace(text, pos);
+        if (pos >= text.size()) return false;
+
+        value = Json();
+        switch (text[pos])
+        {
+            case 'n':
+                return consume(text, pos, "null");
+            case 't':
+                value._type = Type::boolean;
+                value._boolean = true;
+                return consume(text, pos, "true");
+            case 'f':
+                value._type = Type::boolean;
+                return consume(text, pos, "false");
+            case '"':
+                value._type = Type::string;
+                return parse_string(text, pos, value._string);
+            case '[':
+                value._type = Type::array;
+                return parse_array(text, pos, value._array);
+            case '{':
+                value._type = Type::object;
+                return parse_object(text, pos, value._object);
+            default:
+                value._type = Type::number;
+                return parse_number(text, pos, value._number);
+        }
+    }
+
+    static bool parse_number(const std::string& text, size_t& pos, double& number)
+    {
+        const char* begin = text.c_str() + pos;
+        char* end = nullptr;
+        number = std::strtod(begin, &end);
+        if (end == begin) return false;
+
+        pos += static_cast<size_t>(end - begin);
+        return true;
+    }
+
+    static bool parse_string(const std::string& text, size_t& pos, std::string& out)
+    {
+        ++pos; // Opening quote
+        while (pos < text.size())
+        {
+            auto c = text[pos++];
+            if (c == '"') return true;
+            if (c != '\\')
+            {
+                out += c;
+                continue;
+            }
+
+            if (pos >= text.size()) return false;
+            switch (text[pos++])
+            {
+                case '"':  out += '"';  break;
+                case '\\': out += '\\'; break;
+                case '/':  out += '/';  break;
+                case 'b':  out += '\b'; break;
+                case 'f':  out += '\f'; break;
+                case 'n':  out += '\n'; break;
+                case 'r':  out += '\r'; break;
+                case 't':  out += '\t'; break;
+                case 'u':
+                {
+                    if (pos + 4 > text.size()) return false;
+                    auto code = std::strtoul(text.substr(pos, 4).c_str(), nullptr, 16);
+                    pos += 4;
+                    // Only the ASCII range is ever written by this library
+                    out += (code < 0x80) ? static_cast<char>(code) : '?';
+                    break;
+                }
+                default:
+                    return false;
+            }
+        }
+        return false;
+    }
+
+    static bool parse_array(const std::string& text, size_t& pos, array_type& array)
+    {
+        ++pos; // Opening bracket
+        skip_whitespace(text, pos);
+        if (pos < text.size() && text[pos] == ']')
+        {
+            ++pos;
+            return true;
+        }
+
+        while (true)
+        {
+            Json element;
+            if (!parse_value(text, pos, element)) return false;
+            array.push_back(std::move(element));
+
+            skip_whitespace(text, pos);
+            if (pos >= text.size()) return false;
+            if (text[pos] == ']')
+            {
+                ++pos;
+                return true;
+            }
+            if (text[pos++] != ',') return false;
+        }
+    }
+
+    static bool parse_object(const std::string& text, size_t& pos, object_type& object)
+    {
+        ++pos; // Opening brace
+        skip_whitespace(text, pos);
+        if (pos < text.size() && text[pos] == '}')
+        {
+            ++pos;
+            return true;
+        }
+
+        while (true)
+        {
+            std::string key;
+            skip_whitespace(text, pos);
+            if (pos >= text.size() || text[pos] != '"') return false;
+            if (!parse_string(text, pos, key)) return false;
+
+            skip_whitespace(text, pos);
+            if (pos >= text.size() || text[pos++] != ':') return false;
+
+            Json member;
+            if (!parse_value(text, pos, member)) return false;
+            object[key] = std::move(member);
+
+            skip_whitespace(text, pos);
+            if (pos >= text.size()) return false;
+            if (text[pos] == '}')
+            {
+                ++pos;
+                return true;
+            }
+            if (text[pos++] != ',') return false;
+        }
+    }
+
+private: // Members
+    Type        _type;
+    bool        _boolean;
+    double      _number;
+    std::string _string;
+    array_type  _array;
+    object_type _object;
+};
+
+} // namespace bm
+
+#endif // BENCHMARK_JSON_HPP
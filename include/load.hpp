@@ -0,0 +1,191 @@
+/*
+ *  Copyright 2016-present Daniel Trugman
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#ifndef BENCHMARK_LOAD_HPP
+#define BENCHMARK_LOAD_HPP
+
+#include <iostream>
+#include <cstdint>
+#include <vector>
+#include <thread>
+#include <chrono>
+#include <random>
+#include <cmath>
+
+#include "mark.hpp"
+#include "histogram.hpp"
+
+namespace bm {
+
+struct LoadOptions
+{
+    enum class Arrivals { constant, poisson };
+
+    LoadOptions() :
+        rate(1000),
+        duration(std::chrono::seconds(1)),
+        threads(1),
+        arrivals(Arrivals::constant),
+        seed(0) {}
+
+    double            rate;     // Requests per second, of all threads together
+    Mark::nanoseconds duration; // Requests are scheduled during this period
+    unsigned          threads;
+    Arrivals          arrivals;
+    uint64_t          seed;     // Of the Poisson arrivals
+};
+
+struct LoadResult
+{
+    LoadResult() : requests(0), elapsed(0) {}
+
+    // From the intended start of every request to its completion.
+    // Includes the time a request waited behind a stalled one.
+    Mark      latency;
+    Histogram latency_histogram;
+
+    // From the actual start of every request to its completion,
+    // which is what a closed loop measures
+    Mark      service;
+    Histogram service_histogram;
+    Histogram corrected_histogram; // Of service times, with coordinated omission correction
+
+    uint64_t          requests;
+    Mark::nanoseconds elapsed;
+
+    double achieved_rate() const
+    {
+        return (elapsed.count() == 0) ? 0 : requests * 1e9 / elapsed.count();
+    }
+};
+
+inline std::ostream& operator<<(std::ostream& out, const LoadResult& result)
+{
+    auto line = [&out](const char* title, const Histogram& histogram) {
+        out << title
+            << ": p50 " << histogram.percentile(50) << "ns"
+            << ", p99 " << histogram.percentile(99) << "ns"
+            << ", p99.9 " << histogram.percentile(99.9) << "ns"
+            << ", max " << histogram.maximal() << "ns\n";
+    };
+
+    out << result.requests << " requests at " << result.achieved_rate() << " per second\n";
+    line("Latency  ", result.latency_histogram);
+    line("Service  ", result.service_histogram);
+    line("Corrected", result.corrected_histogram);
+    return out;
+}
+
+namespace detail {
+
+// Sleep most of the way, then spin, so requests start on time
+inline void wait_until(std::chrono::steady_clock::time_point when)
+{
+    static const std::chrono::microseconds spin(100);
+
+    auto now = std::chrono::steady_clock::now();
+    if (when - now > spin)
+    {
+        std::this_thread::sleep_until(when - spin);
+    }
+    while (std::chrono::steady_clock::now() < when)
+        ;
+}
+
+} // namespace detail
+
+// Issue calls to func() at the given rate, regardless of how long previous
+// calls took (an open loop). Every worker thread issues its share of the
+// requests, one after the other, so a stalled call delays the following ones
+// and that delay is accounted for in their latency.
+// Without a positive, finite rate, no requests are issued at all.
+template < class Func >
+LoadResult generate_load(Func&& func, const LoadOptions& opts = LoadOptions())
+{
+    using clock = std::chrono::steady_clock;
+
+    if (!(opts.rate > 0) || !std::isfinite(opts.rate)) return LoadResult();
+
+    auto threads = (opts.threads == 0) ? 1 : opts.threads;
+    auto interval = std::chrono::duration<double, std::nano>(1e9 * threads / opts.rate);
+
+    std::vector<LoadResult> results(threads);
+    std::vector<std::thread> workers;
+
+    auto start = clock::now() + std::chrono::milliseconds(1);
+    auto deadline = start + opts.duration;
+
+    for (unsigned t = 0; t < threads; ++t)
+    {
+        workers.emplace_back([&, t]() {
+            auto& result = results[t];
+            std::mt19937_64 engine(opts.seed + t);
+            std::exponential_distribution<double> poisson(1.0 / interval.count());
+
+            // Spread the first requests of the workers evenly
+            std::chrono::duration<double, std::nano> offset(interval.count() * t / threads);
+            auto expected = std::chrono::duration_cast<Mark::nanoseconds>(interval).count();
+
+            while (true)
+            {
+                auto intended = start + std::chrono::duration_cast<clock::duration>(offset);
+                if (intended >= deadline) break;
+
+                detail::wait_until(intended);
+
+                auto before = clock::now();
+                func();
+                auto after = clock::now();
+
+                auto latency = std::chrono::duration_cast<Mark::nanoseconds>(after - intended);
+                auto service = std::chrono::duration_cast<Mark::nanoseconds>(after - before);
+
+                result.latency += latency;
+                result.latency_histogram.add(latency.count());
+                result.service += service;
+                result.service_histogram.add(service.count());
+                result.corrected_histogram.add_corrected(service.count(), expected);
+                ++result.requests;
+
+                offset += (opts.arrivals == LoadOptions::Arrivals::poisson)
+                    ? std::chrono::duration<double, std::nano>(poisson(engine))
+                    : interval;
+            }
+        });
+    }
+
+    for (auto& worker : workers)
+    {
+        worker.join();
+    }
+
+    LoadResult total;
+    for (const auto& result : results)
+    {
+        total.latency             += result.latency;
+        total.latency_histogram   += result.latency_histogram;
+        total.service             += result.service;
+        total.service_histogram   += result.service_histogram;
+        total.corrected_histogram += result.corrected_histogram;
+        total.requests            += result.requests;
+    }
+    total.elapsed = std::chrono::duration_cast<Mark::nanoseconds>(clock::now() - start);
+    return total;
+}
+
+} // namespace bm
+
+#endif // BENCHMARK_LOAD_HPP
@@ -17,11 +17,18 @@
 #ifndef BENCHMARK_MARK_HPP
 #define BENCHMARK_MARK_HPP
 
+#include <algorithm>
+#include <iostream>
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <limits>
 #include <ratio>
 #include <chrono>
-#include <sstream>
 #include <functional>
 
+#include "simd.hpp"
+
 namespace bm
 {
 
@@ -103,6 +110,14 @@ public: // Total, accumulated time getters
 
     int64_t iterations() const { return _iterations; }
 
+public: // Throughput getters
+    uint64_t bytes() const { return _bytes; }
+    uint64_t items() const { return _items; }
+
+    // Rates over the accumulated time
+    double bytes_per_second() const { return per_second(_bytes); }
+    double items_per_second() const { return per_second(_items); }
+
 public: // Min/Max/Avg getters
     Mark average() const
     {
@@ -113,19 +128,114 @@ public: // Min/Max/Avg getters
     Mark maximal() const { return Mark(_max); }
 
 public: // Methods
+    // Aggregate a batch of iterations that were timed together.
+    // Min/Max are tracked using the per-iteration average of the batch.
+    template < class Rep, class Period >
+    Mark& add_batch(const std::chrono::duration<Rep, Period>& duration, uint64_t iterations)
+    {
+        if (iterations == 0) return *this;
+
+        auto ns = std::chrono::duration_cast<nanoseconds>(duration);
+        auto avg = ns / static_cast<int64_t>(iterations);
+        return add(iterations, ns, avg, avg);
+    }
+
+    // Aggregate precomputed values, e.g. ones restored from a file
+    Mark& add(uint64_t iterations,
+              const nanoseconds& total,
+              const nanoseconds& max,
+              const nanoseconds& min)
+    {
+        if (wraps(_total, total))
+        {
+            if (_overflow_callback)
+            {
+                _overflow_callback(*this);
+            }
+
+            _total      = total;
+            _iterations = iterations;
+        }
+        else
+        {
+            _total      += total;
+            _iterations += iterations;
+        }
+
+        _max = (std::max)(_max, max);
+        _min = (std::min)(_min, min);
+
+        return *this;
+    }
+
+    // Aggregate many durations (in nanoseconds) at once, one iteration each.
+    // Vectorized, and checked for overflow per block of values rather than
+    // per value, so on overflow the aggregation restarts at a block boundary.
+    Mark& add_bulk(const int64_t* ns, size_t n)
+    {
+        static const size_t  block = 4096;
+        static const int64_t limit = (std::numeric_limits<int64_t>::max)() / block;
+
+        for (size_t offset = 0; offset < n; offset += block)
+        {
+            auto count = (std::min)(n - offset, block);
+            auto summary = simd::summarize(ns + offset, count);
+
+            // The sum of the block might have overflowed
+            if (summary.max > limit || summary.min < -limit)
+            {
+                for (size_t i = 0; i < count; ++i) add(nanoseconds(ns[offset + i]));
+                continue;
+            }
+
+            add(count, nanoseconds(summary.sum), nanoseconds(summary.max), nanoseconds(summary.min));
+        }
+        return *this;
+    }
+
+    // Account for data processed during the accumulated time
+    Mark& add_bytes(uint64_t bytes) { _bytes += bytes; return *this; }
+    Mark& add_items(uint64_t items) { _items += items; return *this; }
+
     void clear()
     {
         _min = (nanoseconds::max)();
         _max = (nanoseconds::min)();
         _total = nanoseconds(0);
         _iterations = 0;
+        _bytes = 0;
+        _items = 0;
+    }
+
+    // Write a one-line summary with auto-scaled units, e.g.
+    // "total 1.23s, 1000 iterations, min/avg/max 1.10ms/1.23ms/2.05ms",
+    // without allocating. Returns the length of the full summary, like
+    // snprintf: the output was truncated if it is not less than n.
+    size_t format_to(char* buf, size_t n) const
+    {
+        Writer writer(buf, n);
+        writer.put("total ");
+        writer.put_duration(_total.count());
+        writer.put(", ");
+        writer.put_uint(_iterations);
+        writer.put(" iterations");
+        if (_iterations != 0)
+        {
+            writer.put(", min/avg/max ");
+            writer.put_duration(_min.count());
+            writer.put("/");
+            writer.put_duration(_total.count() / static_cast<int64_t>(_iterations));
+            writer.put("/");
+            writer.put_duration(_max.count());
+        }
+        return writer.finish();
     }
 
     std::string to_string() const
     {
-        std::ostringstream out;
-        out << *this;
-        return out.str();
+        char buf[format_size];
+        auto length = format_to(buf, sizeof(buf));
+        return std::string(buf, (std::min)(length, sizeof(buf) - 1));
     }
 
 private: // Methods
@@ -138,48 +248,131 @@ private: // Methods
 
     Mark& add(const Mark& rhs)
     {
-        return add(rhs._iterations, rhs._total, rhs._max, rhs._min);
+        // On overflow, the accumulated time restarts from rhs, so do the counters
+        bool restart = wraps(_total, rhs._total);
+        add(rhs._iterations, rhs._total, rhs._max, rhs._min);
+
+        _bytes = restart ? rhs._bytes : _bytes + rhs._bytes;
+        _items = restart ? rhs._items : _items + rhs._items;
+        return *this;
     }
 
-    Mark& add(uint64_t iterations,
-              const nanoseconds& total,
-              const nanoseconds& max,
-              const nanoseconds& min)
+    double per_second(uint64_t count) const
+    {
+        return (_total.count() <= 0) ? 0 : count * 1e9 / _total.count();
+    }
+
+    // Whether total + added < total, with the sum wrapping around rather than
+    // overflowing, which is undefined and lets the compiler drop the check
+    static bool wraps(const nanoseconds& total, const nanoseconds& added)
     {
-        if (_total + total < _total)
+        auto sum = static_cast<uint64_t>(total.count()) + static_cast<uint64_t>(added.count());
+        return static_cast<int64_t>(sum) < total.count();
+    }
+
+private: // Formatting
+    // Large enough for any summary
+    static const size_t format_size = 160;
+
+    // Appends what fits into the buffer, but counts everything
+    class Writer
+    {
+    public:
+        Writer(char* buf, size_t n) : _buf(buf), _size(n), _length(0) {}
+
+        void put(char c)
         {
-            if (_overflow_callback)
+            if (_length + 1 < _size) _buf[_length] = c;
+            ++_length;
+        }
+
+        void put(const char* text)
+        {
+            for (; *text; ++text) put(*text);
+        }
+
+        void put_uint(uint64_t value, unsigned min_digits = 1)
+        {
+            char digits[20];
+            unsigned count = 0;
+            do
             {
-                _overflow_callback(*this);
-            }
+                digits[count++] = static_cast<char>('0' + value % 10);
+                value /= 10;
+            } while (value != 0 || count < min_digits);
 
-            _total      = total;
-            _iterations = iterations;
+            while (count) put(digits[--count]);
         }
-        else
+
+        // Three significant digits at least, in the largest fitting unit up to seconds
+        void put_duration(int64_t ns)
         {
-            _total      += total;
-            _iterations += iterations;
+            auto value = static_cast<uint64_t>(ns);
+            if (ns < 0)
+            {
+                put('-');
+                value = 0 - value;
+            }
+
+            if (value < 1000)
+            {
+                put_uint(value);
+                put("ns");
+                return;
+            }
+
+            static const char* const suffixes[] = { "us", "ms", "s" };
+            uint64_t unit = 1000;
+            unsigned scale = 0;
+            while (scale < 2 && value >= unit * 1000) { unit *= 1000; ++scale; }
+
+            // Hundredths, rounded to nearest, possibly into the next unit
+            auto whole = value / unit;
+            auto hundredths = (value % unit * 100 + unit / 2) / unit;
+            if (hundredths == 100)
+            {
+                ++whole;
+                hundredths = 0;
+            }
+            if (whole == 1000 && scale < 2)
+            {
+                whole = 1;
+                ++scale;
+            }
+
+            put_uint(whole);
+            put('.');
+            put_uint(hundredths, 2);
+            put(suffixes[scale]);
         }
 
-        _max = (std::max)(_max, max);
-        _min = (std::min)(_min, min);
+        size_t finish()
+        {
+            if (_size != 0) _buf[(std::min)(_length, _size - 1)] = '\0';
+            return _length;
+        }
 
-        return *this;
-    }
+    private:
+        char*  _buf;
+        size_t _size;
+        size_t _length;
+    };
 
 private: // Members
     nanoseconds       _min;
     nanoseconds       _max;
     nanoseconds       _total;
     uint64_t          _iterations;
+    uint64_t          _bytes;
+    uint64_t          _items;
     overflow_callback _overflow_callback;
 };
 
 inline std::ostream& operator<<(std::ostream& out, const Mark& mark)
 {
-    out << "Total of " << mark._total.count() << "ns after " << mark._iterations << " iterations";
-    return out;
+    char buf[Mark::format_size];
+    auto length = mark.format_to(buf, sizeof(buf));
+    return out.write(buf, static_cast<std::streamsize>((std::min)(length, sizeof(buf) - 1)));
 }
 
 } // namespace bm
@@ -0,0 +1,270 @@
+/*
+ *  Copyright 2016-present Daniel Trugman
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#ifndef BENCHMARK_MEMORY_PROFILE_HPP
+#define BENCHMARK_MEMORY_PROFILE_HPP
+
+#include <algorithm>
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <vector>
+#include <chrono>
+
+#include "benchmark.hpp"
+#include "cache.hpp"
+#include "random.hpp"
+#include "runner.hpp"
+
+namespace bm {
+
+struct MemoryOptions
+{
+    MemoryOptions() :
+        min_bytes(4 << 10),
+        max_bytes(0),
+        multiplier(4),
+        min_time(std::chrono::milliseconds(20)),
+        chase_steps(1 << 18) {}
+
+    size_t            min_bytes;   // Smallest working set
+    size_t            max_bytes;   // Largest working set, 0 means four times the last level cache
+    size_t            multiplier;  // Growth of the working set from one point of the curve to the next
+    Mark::nanoseconds min_time;    // Measured time per kernel and working set
+    size_t            chase_steps; // Dependent loads per timed pointer chase
+};
+
+// The ceilings of a certain working set, bandwidths in bytes per second.
+// Bandwidths are those of the fastest pass, as in STREAM.
+struct MemoryPoint
+{
+    MemoryPoint() : bytes(0), read(0), write(0), copy(0), latency_ns(0) {}
+
+    size_t bytes;
+    double read;
+    double write;
+    double copy;       // Bytes read plus bytes written
+    double latency_ns; // Of a load depending on the previous one, i.e. pointer chasing
+};
+
+// Bandwidth and latency as a function of the working set, from L1 to memory
+struct MemoryProfile
+{
+    std::vector<MemoryPoint> points; // By ascending working set
+
+    // The read bandwidth of the largest working set, i.e. of memory rather than caches
+    double memory_bandwidth() const
+    {
+        return points.empty() ? 0 : points.back().read;
+    }
+
+    // The read bandwidth of the smallest measured working set that holds the given one
+    double bandwidth(size_t working_set) const
+    {
+        for (const auto& point : points)
+        {
+            if (point.bytes >= working_set) return point.read;
+        }
+        return memory_bandwidth();
+    }
+
+    // The throughput of a Mark relative to the bandwidth of its working set,
+    // 0 meaning memory. Marks count their bytes with add_bytes().
+    double utilization(const Mark& mark, size_t working_set = 0) const
+    {
+        auto ceiling = (working_set == 0) ? memory_bandwidth() : bandwidth(working_set);
+        return (ceiling <= 0) ? 0 : mark.bytes_per_second() / ceiling;
+    }
+
+    // e.g. "42.0% of memory bandwidth (4.10GB/s of 9.76GB/s)"
+    std::string context(const Mark& mark, size_t working_set = 0) const
+    {
+        auto ceiling = (working_set == 0) ? memory_bandwidth() : bandwidth(working_set);
+
+        std::ostringstream out;
+        out << std::fixed << std::setprecision(1) << utilization(mark, working_set) * 100 << "% of "
+            << ((working_set == 0) ? "memory" : format_bytes(working_set) + " working set") << " bandwidth"
+            << std::setprecision(2)
+            << " (" << mark.bytes_per_second() / 1e9 << "GB/s of " << ceiling / 1e9 << "GB/s)";
+        return out.str();
+    }
+
+    // e.g. 4KiB, 16MiB
+    static std::string format_bytes(size_t bytes)
+    {
+        static const char* units[] = { "B", "KiB", "MiB", "GiB", "TiB" };
+
+        size_t unit = 0;
+        while (bytes >= 1024 && bytes % 1024 == 0 && unit + 1 < sizeof(units) / sizeof(units[0]))
+        {
+            bytes /= 1024;
+            ++unit;
+        }
+        return std::to_string(bytes) + units[unit];
+    }
+};
+
+// The curve, one working set per line
+inline std::ostream& operator<<(std::ostream& out, const MemoryProfile& profile)
+{
+    auto flags = out.flags();
+    auto precision = out.precision(2);
+    out << std::fixed
+        << std::setw(12) << "working set"
+        << std::setw(12) << "read GB/s"
+        << std::setw(12) << "write GB/s"
+        << std::setw(12) << "copy GB/s"
+        << std::setw(12) << "latency ns" << "\n";
+
+    for (const auto& point : profile.points)
+    {
+        out << std::setw(12) << MemoryProfile::format_bytes(point.bytes)
+            << std::setw(12) << point.read / 1e9
+            << std::setw(12) << point.write / 1e9
+            << std::setw(12) << point.copy / 1e9
+            << std::setw(12) << point.latency_ns << "\n";
+    }
+
+    out.precision(precision);
+    out.flags(flags);
+    return out;
+}
+
+namespace detail {
+
+// The fastest of repeated timed calls of kernel(), lasting min_time together
+template < class Kernel >
+double fastest_ns(Kernel kernel, const MemoryOptions& opts)
+{
+    Mark mark;
+    while (mark.iterations() < 3 || mark.as_nanoseconds() < opts.min_time.count())
+    {
+        auto timed = Bench::mark(kernel);
+        do_not_optimize(timed.second);
+        mark += timed.first;
+    }
+    return static_cast<double>((std::max)(mark.minimal().as_nanoseconds(), static_cast<int64_t>(1)));
+}
+
+inline MemoryPoint measure_memory(size_t bytes, const MemoryOptions& opts)
+{
+    static const size_t line = cache::sizes().line;
+    static const size_t min_pass = 1 << 20;
+
+    MemoryPoint point;
+    point.bytes = bytes;
+
+    // Small working sets are passed over several times per timed call,
+    // so the clock overhead remains negligible
+    auto words = bytes / sizeof(uint64_t);
+    auto passes = (std::max)(min_pass / bytes, static_cast<size_t>(1));
+    auto moved = static_cast<double>(bytes * passes);
+
+    std::vector<uint64_t> data(words, 1);
+    point.read = moved / fastest_ns([&]() {
+        uint64_t sums[4] = { 0, 0, 0, 0 };
+        for (size_t pass = 0; pass < passes; ++pass)
+        {
+            for (size_t i = 0; i + 4 <= words; i += 4)
+            {
+                sums[0] += data[i];
+                sums[1] += data[i + 1];
+                sums[2] += data[i + 2];
+                sums[3] += data[i + 3];
+            }
+        }
+        return sums[0] + sums[1] + sums[2] + sums[3];
+    }, opts) * 1e9;
+
+    uint64_t value = 0;
+    point.write = moved / fastest_ns([&]() {
+        for (size_t pass = 0; pass < passes; ++pass)
+        {
+            std::fill(data.begin(), data.end(), ++value);
+        }
+        return data[words / 2];
+    }, opts) * 1e9;
+
+    // Both halves together make up the working set
+    auto half = words / 2;
+    point.copy = moved / fastest_ns([&]() {
+        for (size_t pass = 0; pass < passes; ++pass)
+        {
+            std::copy(data.begin(), data.begin() + half, data.begin() + half);
+        }
+        return data[half];
+    }, opts) * 1e9;
+
+    // A single random cycle through all the lines of the working set,
+    // so every load misses whatever the prefetchers guess
+    auto stride = (std::max)(line / sizeof(uint64_t), static_cast<size_t>(1));
+    auto lines = (std::max)(words / stride, static_cast<size_t>(1));
+    std::vector<uint32_t> order(lines);
+    for (size_t i = 0; i < lines; ++i) order[i] = static_cast<uint32_t>(i);
+
+    Xoshiro256 engine(lines);
+    for (auto i = lines - 1; i > 0; --i)
+    {
+        std::swap(order[i], order[bounded(engine, static_cast<uint32_t>(i))]); // Sattolo's algorithm
+    }
+    for (size_t i = 0; i < lines; ++i)
+    {
+        data[order[i] * stride] = order[(i + 1) % lines] * stride;
+    }
+
+    auto steps = (std::max)(opts.chase_steps, static_cast<size_t>(1));
+    point.latency_ns = fastest_ns([&]() {
+        uint64_t index = 0;
+        for (size_t step = 0; step < steps; ++step)
+        {
+            index = data[index];
+        }
+        return index;
+    }, opts) / steps;
+
+    return point;
+}
+
+} // namespace detail
+
+// Measure sequential read, write and copy bandwidth (STREAM-like) and pointer
+// chasing latency for working sets from opts.min_bytes to opts.max_bytes.
+// The curve takes a few seconds, and as much memory as the largest working set.
+inline MemoryProfile profile_memory(const MemoryOptions& opts = MemoryOptions())
+{
+    static const size_t granularity = 2 * cache::sizes().line;
+
+    auto max_bytes = (opts.max_bytes != 0) ? opts.max_bytes : 4 * cache::sizes().llc;
+    auto multiplier = (std::max)(opts.multiplier, static_cast<size_t>(2));
+
+    MemoryProfile profile;
+    for (auto bytes = (std::max)(opts.min_bytes, granularity); ; bytes *= multiplier)
+    {
+        bytes = (std::min)(bytes, max_bytes);
+        bytes = (std::max)(bytes - bytes % granularity, granularity);
+        profile.points.push_back(detail::measure_memory(bytes, opts));
+
+        if (bytes >= max_bytes - max_bytes % granularity) break;
+    }
+    return profile;
+}
+
+} // namespace bm
+
+#endif // BENCHMARK_MEMORY_PROFILE_HPP
@@ -0,0 +1,191 @@
+/*
+ *  Copyright 2016-present Daniel Trugman
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#ifndef BENCHMARK_PERIODIC_HPP
+#define BENCHMARK_PERIODIC_HPP
+
+#include <condition_variable>
+#include <functional>
+#include <iostream>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+#include <thread>
+#include <chrono>
+#include <mutex>
+
+#include "mark.hpp"
+#include "atomic_mark.hpp"
+
+namespace bm {
+
+// The values every registered mark aggregated during a reporting interval
+struct Interval
+{
+    struct Entry
+    {
+        std::string name;
+        Mark        mark;
+    };
+
+    Interval() : elapsed(0) {}
+
+    Mark::nanoseconds  elapsed; // Since the previous report
+    std::vector<Entry> entries;
+};
+
+// Reports "stats for the last N seconds" of AtomicMarks from a background
+// thread. Every interval, the marks are exchanged for empty ones, so probes
+// keep writing without ever waiting for the reporter.
+class PeriodicReporter
+{
+public: // Types
+    using sink_type = std::function<void(const Interval&)>;
+    using clock     = std::chrono::steady_clock;
+
+public: // C'tors
+    PeriodicReporter(Mark::nanoseconds interval, sink_type sink) :
+        _interval(interval), _sink(std::move(sink)), _running(false), _last(clock::now()) {}
+
+    ~PeriodicReporter() { stop(); }
+
+    PeriodicReporter(const PeriodicReporter&) = delete;
+    PeriodicReporter& operator=(const PeriodicReporter&) = delete;
+
+public: // Methods
+    // The mark must outlive the reporter
+    void add(const std::string& name, AtomicMark& mark)
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _marks.push_back(std::make_pair(name, &mark));
+    }
+
+    void start()
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (_running) return;
+
+        _running = true;
+        _last = clock::now();
+        _thread = std::thread(&PeriodicReporter::loop, this);
+    }
+
+    // Stop the thread, and report what was left of the current interval
+    void stop()
+    {
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            if (!_running) return;
+
+            _running = false;
+        }
+        _wakeup.notify_all();
+        _thread.join();
+
+        report();
+    }
+
+    // Report the current interval immediately, and start a new one.
+    // Reports are serialized, so sinks need not be thread-safe and receive
+    // the intervals in order.
+    void report()
+    {
+        std::lock_guard<std::mutex> sink_lock(_sink_mutex);
+
+        Interval interval;
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+
+            auto now = clock::now();
+            interval.elapsed = std::chrono::duration_cast<Mark::nanoseconds>(now - _last);
+            _last = now;
+
+            interval.entries.reserve(_marks.size());
+            for (const auto& mark : _marks)
+            {
+                Interval::Entry entry;
+                entry.name = mark.first;
+                entry.mark = mark.second->exchange();
+                interval.entries.push_back(std::move(entry));
+            }
+        }
+
+        if (_sink) _sink(interval);
+    }
+
+public: // Sinks
+    // One line per mark, with its rate over the interval
+    static sink_type stream_sink(std::ostream& out)
+    {
+        return [&out](const Interval& interval) { write(out, interval); };
+    }
+
+    // Appends to the file, an empty sink if it cannot be opened
+    static sink_type file_sink(const std::string& path)
+    {
+        auto file = std::make_shared<std::ofstream>(path, std::ios::app);
+        if (!*file) return nullptr;
+
+        return [file](const Interval& interval) { write(*file, interval); };
+    }
+
+private: // Methods
+    void loop()
+    {
+        std::unique_lock<std::mutex> lock(_mutex);
+        auto next = clock::now() + _interval;
+        while (true)
+        {
+            if (_wakeup.wait_until(lock, next, [this]() { return !_running; })) break;
+
+            next += _interval;
+            lock.unlock();
+            report();
+            lock.lock();
+        }
+    }
+
+    static void write(std::ostream& out, const Interval& interval)
+    {
+        char buf[192];
+        auto seconds = interval.elapsed.count() / 1e9;
+        for (const auto& entry : interval.entries)
+        {
+            auto length = entry.mark.format_to(buf, sizeof(buf));
+            out << entry.name << ": ";
+            out.write(buf, static_cast<std::streamsize>((std::min)(length, sizeof(buf) - 1)));
+            out << ", " << (seconds > 0 ? entry.mark.iterations() / seconds : 0) << "/s\n";
+        }
+        out.flush();
+    }
+
+private: // Members
+    Mark::nanoseconds       _interval;
+    sink_type               _sink;
+    std::mutex              _mutex;
+    std::mutex              _sink_mutex; // Taken before _mutex, held while reporting
+    std::condition_variable _wakeup;
+    bool                    _running;
+    std::thread             _thread;
+    clock::time_point       _last;
+
+    std::vector<std::pair<std::string, AtomicMark*>> _marks;
+};
+
+} // namespace bm
+
+#endif // BENCHMARK_PERIODIC_HPP
@@ -0,0 +1,65 @@
+/*
+ *  Copyright 2016-present Daniel Trugman
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#ifndef BENCHMARK_PROCESS_CLOCK_HPP
+#define BENCHMARK_PROCESS_CLOCK_HPP
+
+#include <chrono>
+#include <cstdint>
+
+#if defined __linux__
+#   include <unistd.h>
+#   ifdef _POSIX_CPUTIME
+#       define BENCHMARK_PROCESS_CPUTIME
+#   endif
+#endif
+
+#ifdef BENCHMARK_PROCESS_CPUTIME
+
+#include <time.h>
+
+namespace bm {
+
+// A definition of a process clock according to std::chrono, based on the
+// CLOCK_PROCESS_CPUTIME_ID implementation, i.e. the CPU time of all threads
+struct process_clock
+{
+    using duration   = std::chrono::nanoseconds;
+    using rep        = duration::rep;
+    using period     = duration::period;
+    using time_point = std::chrono::time_point<process_clock>;
+
+    static const bool is_steady = true;
+
+    static bool supported() noexcept
+    {
+        struct timespec ts = {};
+        return clock_getres(CLOCK_PROCESS_CPUTIME_ID, &ts) == 0;
+    }
+
+    static time_point now() noexcept
+    {
+        struct timespec ts = {};
+        clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);
+        return time_point(duration(((uint64_t)ts.tv_sec * 1000000000) + (uint64_t)ts.tv_nsec));
+    }
+};
+
+} // namespace bm
+
+#endif // BENCHMARK_PROCESS_CPUTIME
+
+#endif // BENCHMARK_PROCESS_CLOCK_HPP
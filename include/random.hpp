@@ -0,0 +1,272 @@
+/*
+ *  Copyright 2016-present Daniel Trugman
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#ifndef BENCHMARK_RANDOM_HPP
+#define BENCHMARK_RANDOM_HPP
+
+#include <algorithm>
+#include <cstdint>
+#include <cstddef>
+#include <limits>
+
+#include "simd.hpp"
+
+namespace bm {
+
+// SplitMix64, mostly used to expand a single seed into a generator's state
+class SplitMix64
+{
+public:
+    using result_type = uint64_t;
+
+    explicit SplitMix64(uint64_t seed = 0) : _state(seed) {}
+
+    static constexpr result_type min() { return 0; }
+    static constexpr result_type max() { return (std::numeric_limits<result_type>::max)(); }
+
+    result_type operator()()
+    {
+        auto z = (_state += 0x9e3779b97f4a7c15ULL);
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+        return z ^ (z >> 31);
+    }
+
+private:
+    uint64_t _state;
+};
+
+// xoshiro256** by Blackman and Vigna: fast, small and statistically sound,
+// but not cryptographically secure. Satisfies UniformRandomBitGenerator.
+class Xoshiro256
+{
+public:
+    using result_type = uint64_t;
+
+    explicit Xoshiro256(uint64_t seed = 0)
+    {
+        SplitMix64 expand(seed);
+        for (auto& word : _state) word = expand();
+    }
+
+    static constexpr result_type min() { return 0; }
+    static constexpr result_type max() { return (std::numeric_limits<result_type>::max)(); }
+
+    result_type operator()()
+    {
+        auto result = rotl(_state[1] * 5, 7) * 9;
+        auto t = _state[1] << 17;
+
+        _state[2] ^= _state[0];
+        _state[3] ^= _state[1];
+        _state[1] ^= _state[2];
+        _state[0] ^= _state[3];
+        _state[2] ^= t;
+        _state[3] = rotl(_state[3], 45);
+
+        return result;
+    }
+
+    // Advance by 2^128 calls, e.g. to give every thread its own subsequence
+    void jump()
+    {
+        static const uint64_t polynomial[] = {
+            0x180ec6d33cfd0abaULL, 0xd5a61266f0c9392cULL, 0xa9582618e03fc9aaULL, 0x39abdc4529b1661cULL };
+
+        uint64_t state[4] = { 0, 0, 0, 0 };
+        for (auto word : polynomial)
+        {
+            for (int bit = 0; bit < 64; ++bit)
+            {
+                if (word & (static_cast<uint64_t>(1) << bit))
+                {
+                    for (int i = 0; i < 4; ++i) state[i] ^= _state[i];
+                }
+                (*this)();
+            }
+        }
+        for (int i = 0; i < 4; ++i) _state[i] = state[i];
+    }
+
+    uint64_t state(size_t word) const { return _state[word]; }
+
+private:
+    static uint64_t rotl(uint64_t x, int k)
+    {
+        return (x << k) | (x >> (64 - k));
+    }
+
+private:
+    uint64_t _state[4];
+};
+
+// Four xoshiro256** streams advanced together, which fill buffers four
+// numbers at a time, using AVX2 where supported. Stream i is the one of
+// Xoshiro256(seed) jumped i times, and buffers hold the streams interleaved.
+// Also a UniformRandomBitGenerator, drawing from a buffer filled in batches.
+class Xoshiro256x4
+{
+public:
+    using result_type = uint64_t;
+
+    static const size_t lanes      = 4;
+    static const size_t batch_size = 256;
+
+    explicit Xoshiro256x4(uint64_t seed = 0) : _next(batch_size)
+    {
+        Xoshiro256 stream(seed);
+        for (size_t lane = 0; lane < lanes; ++lane)
+        {
+            for (size_t word = 0; word < 4; ++word)
+            {
+                _state[word][lane] = stream.state(word);
+            }
+            stream.jump();
+        }
+    }
+
+    static constexpr result_type min() { return 0; }
+    static constexpr result_type max() { return (std::numeric_limits<result_type>::max)(); }
+
+    result_type operator()()
+    {
+        if (_next == batch_size)
+        {
+            fill(_batch, batch_size);
+            _next = 0;
+        }
+        return _batch[_next++];
+    }
+
+    // Any isa but scalar takes the AVX2 path, and must be supported.
+    // When n isn't a multiple of four, the rest of the last group is dropped.
+    void fill(uint64_t* out, size_t n, simd::Isa isa)
+    {
+        auto groups = n / lanes;
+#ifdef BENCHMARK_SIMD_X86
+        if (isa != simd::Isa::scalar)
+        {
+            fill_avx2(out, groups);
+        }
+        else
+#endif // BENCHMARK_SIMD_X86
+        {
+            (void)isa;
+            fill_scalar(out, groups);
+        }
+
+        if (n % lanes != 0)
+        {
+            uint64_t group[lanes];
+            fill_scalar(group, 1);
+            std::copy(group, group + n % lanes, out + groups * lanes);
+        }
+    }
+
+    void fill(uint64_t* out, size_t n)
+    {
+        fill(out, n, simd::best());
+    }
+
+private:
+    static uint64_t rotl(uint64_t x, int k)
+    {
+        return (x << k) | (x >> (64 - k));
+    }
+
+    void fill_scalar(uint64_t* out, size_t groups)
+    {
+        auto& s = _state;
+        for (size_t group = 0; group < groups; ++group)
+        {
+            for (size_t lane = 0; lane < lanes; ++lane)
+            {
+                out[group * lanes + lane] = rotl(s[1][lane] * 5, 7) * 9;
+                auto t = s[1][lane] << 17;
+
+                s[2][lane] ^= s[0][lane];
+                s[3][lane] ^= s[1][lane];
+                s[1][lane] ^= s[2][lane];
+                s[0][lane] ^= s[3][lane];
+                s[2][lane] ^= t;
+                s[3][lane] = rotl(s[3][lane], 45);
+            }
+        }
+    }
+
+#ifdef BENCHMARK_SIMD_X86
+
+    // AVX2 has no 64-bit multiplication, but x * 5 and x * 9 are a shift and an add
+    __attribute__((target("avx2")))
+    void fill_avx2(uint64_t* out, size_t groups)
+    {
+        auto s0 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(_state[0]));
+        auto s1 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(_state[1]));
+        auto s2 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(_state[2]));
+        auto s3 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(_state[3]));
+
+        for (size_t group = 0; group < groups; ++group)
+        {
+            auto times5 = _mm256_add_epi64(_mm256_slli_epi64(s1, 2), s1);
+            auto rotated = _mm256_or_si256(_mm256_slli_epi64(times5, 7), _mm256_srli_epi64(times5, 57));
+            auto result = _mm256_add_epi64(_mm256_slli_epi64(rotated, 3), rotated);
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + group * lanes), result);
+
+            auto t = _mm256_slli_epi64(s1, 17);
+            s2 = _mm256_xor_si256(s2, s0);
+            s3 = _mm256_xor_si256(s3, s1);
+            s1 = _mm256_xor_si256(s1, s2);
+            s0 = _mm256_xor_si256(s0, s3);
+            s2 = _mm256_xor_si256(s2, t);
+            s3 = _mm256_or_si256(_mm256_slli_epi64(s3, 45), _mm256_srli_epi64(s3, 19));
+        }
+
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(_state[0]), s0);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(_state[1]), s1);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(_state[2]), s2);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(_state[3]), s3);
+    }
+
+#endif // BENCHMARK_SIMD_X86
+
+private:
+    uint64_t _state[4][lanes]; // The state words of every lane, i.e. [word][lane]
+    uint64_t _batch[batch_size];
+    size_t   _next;
+};
+
+// A uniform integer in [0, range), without modulo bias, using Lemire's
+// nearly divisionless method: a division is only needed on rare rejections
+template < class Engine >
+uint32_t bounded(Engine& engine, uint32_t range)
+{
+    auto product = static_cast<uint64_t>(static_cast<uint32_t>(engine())) * range;
+    auto low = static_cast<uint32_t>(product);
+    if (low < range)
+    {
+        auto threshold = static_cast<uint32_t>(0u - range) % range;
+        while (low < threshold)
+        {
+            product = static_cast<uint64_t>(static_cast<uint32_t>(engine())) * range;
+            low = static_cast<uint32_t>(product);
+        }
+    }
+    return static_cast<uint32_t>(product >> 32);
+}
+
+} // namespace bm
+
+#endif // BENCHMARK_RANDOM_HPP
@@ -0,0 +1,257 @@
+/*
+ *  Copyright 2016-present Daniel Trugman
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#ifndef BENCHMARK_REGISTRY_HPP
+#define BENCHMARK_REGISTRY_HPP
+
+#include <functional>
+#include <string>
+#include <vector>
+#include <regex>
+
+#include "runner.hpp"
+
+// The flags of the translation unit registering benchmarks through the
+// BM_REGISTER macros, defined per source by the build system
+#ifndef BENCHMARK_CXX_FLAGS
+#   define BENCHMARK_CXX_FLAGS "unknown"
+#endif
+
+namespace bm {
+
+enum class ClockType { steady, thread, process };
+
+inline const char* to_string(ClockType clock)
+{
+    switch (clock)
+    {
+        case ClockType::steady:  return "steady_clock";
+        case ClockType::thread:  return "thread_clock";
+        case ClockType::process: return "process_clock";
+    }
+    return "unknown";
+}
+
+// A registered benchmark, which knows how to run itself with either clock
+struct Benchmark
+{
+    using runner_type = std::function<Report(const Options&, ClockType)>;
+
+    std::string name;
+    std::string flags; // Its translation unit was compiled with, empty if unknown
+    runner_type run;
+};
+
+class Registry
+{
+public:
+    static Registry& instance()
+    {
+        static Registry registry;
+        return registry;
+    }
+
+public:
+    void add(Benchmark benchmark)
+    {
+        _benchmarks.push_back(std::move(benchmark));
+    }
+
+    const std::vector<Benchmark>& benchmarks() const { return _benchmarks; }
+
+    // Benchmarks whose name contains a match of the regular expression
+    std::vector<const Benchmark*> matching(const std::string& filter) const
+    {
+        std::regex pattern(filter);
+        std::vector<const Benchmark*> matches;
+        for (const auto& benchmark : _benchmarks)
+        {
+            if (std::regex_search(benchmark.name, pattern))
+            {
+                matches.push_back(&benchmark);
+            }
+        }
+        return matches;
+    }
+
+private:
+    Registry() = default;
+
+private:
+    std::vector<Benchmark> _benchmarks;
+};
+
+namespace detail {
+
+// Producers run a benchmark with the runner R, i.e. with a certain clock
+template < class Producer >
+Benchmark make_benchmark(const std::string& name, const std::string& flags, Producer producer)
+{
+    Benchmark benchmark;
+    benchmark.name = name;
+    benchmark.flags = flags;
+    benchmark.run = [producer](const Options& opts, ClockType clock) -> Report {
+#ifdef BENCHMARK_THREAD_CPUTIME
+        if (clock == ClockType::thread)
+        {
+            return producer.template run<ThreadRunner>(opts);
+        }
+#endif // BENCHMARK_THREAD_CPUTIME
+#ifdef BENCHMARK_PROCESS_CPUTIME
+        if (clock == ClockType::process)
+        {
+            return producer.template run<ProcessRunner>(opts);
+        }
+#endif // BENCHMARK_PROCESS_CPUTIME
+        (void)clock;
+        return producer.template run<Runner>(opts);
+    };
+    return benchmark;
+}
+
+inline Report single(const std::string& name, Result result)
+{
+    Report report;
+    report.name = name;
+    report.results.push_back(std::move(result));
+    return report;
+}
+
+template < class Func >
+struct Plain
+{
+    template < class R >
+    Report run(const Options& opts) const
+    {
+        return single(name, R::run(name, func, opts));
+    }
+
+    std::string  name;
+    mutable Func func;
+};
+
+template < class Setup, class Body, class Teardown >
+struct Fixture
+{
+    template < class R >
+    Report run(const Options& opts) const
+    {
+        return single(name, R::fixture(name, setup, body, teardown, opts));
+    }
+
+    std::string      name;
+    mutable Setup    setup;
+    mutable Body     body;
+    mutable Teardown teardown;
+};
+
+template < class Func >
+struct Sweeping
+{
+    template < class R >
+    Report run(const Options& opts) const
+    {
+        return R::sweep(name, sweep, func, opts);
+    }
+
+    std::string  name;
+    Sweep        sweep;
+    mutable Func func;
+};
+
+template < class Setup, class Body, class Teardown >
+struct SweepingFixture
+{
+    template < class R >
+    Report run(const Options& opts) const
+    {
+        return R::sweep_fixture(name, sweep, setup, body, teardown, opts);
+    }
+
+    std::string      name;
+    Sweep            sweep;
+    mutable Setup    setup;
+    mutable Body     body;
+    mutable Teardown teardown;
+};
+
+} // namespace detail
+
+// Registration helpers, mostly used through the BM_REGISTER macros below.
+// Options::threads is ignored by sweeps, which use their own thread counts.
+// The flags are those of the caller's translation unit, which the macros pass
+// as BENCHMARK_CXX_FLAGS; a header can't capture them without breaking ODR.
+
+template < class Func >
+bool register_benchmark(const std::string& name, Func func, const std::string& flags = std::string())
+{
+    detail::Plain<Func> producer = { name, func };
+    Registry::instance().add(detail::make_benchmark(name, flags, producer));
+    return true;
+}
+
+template < class Setup, class Body, class Teardown >
+bool register_fixture(const std::string& name, Setup setup, Body body, Teardown teardown,
+                      const std::string& flags = std::string())
+{
+    detail::Fixture<Setup, Body, Teardown> producer = { name, setup, body, teardown };
+    Registry::instance().add(detail::make_benchmark(name, flags, producer));
+    return true;
+}
+
+template < class Func >
+bool register_sweep(const std::string& name, const Sweep& sweep, Func func,
+                    const std::string& flags = std::string())
+{
+    detail::Sweeping<Func> producer = { name, sweep, func };
+    Registry::instance().add(detail::make_benchmark(name, flags, producer));
+    return true;
+}
+
+template < class Setup, class Body, class Teardown >
+bool register_sweep_fixture(const std::string& name, const Sweep& sweep,
+                            Setup setup, Body body, Teardown teardown,
+                            const std::string& flags = std::string())
+{
+    detail::SweepingFixture<Setup, Body, Teardown> producer = { name, sweep, setup, body, teardown };
+    Registry::instance().add(detail::make_benchmark(name, flags, producer));
+    return true;
+}
+
+} // namespace bm
+
+#define BM_CONCAT_IMPL(a, b) a##b
+#define BM_CONCAT(a, b) BM_CONCAT_IMPL(a, b)
+#define BM_UNIQUE(prefix) BM_CONCAT(prefix, __LINE__)
+
+// Register a benchmark of func()
+#define BM_REGISTER(name, ...) \
+    static const bool BM_UNIQUE(bm_registered_) = ::bm::register_benchmark(name, __VA_ARGS__, BENCHMARK_CXX_FLAGS)
+
+// Register a benchmark of body(state), with a fresh setup() state per iteration
+#define BM_REGISTER_FIXTURE(name, ...) \
+    static const bool BM_UNIQUE(bm_registered_) = ::bm::register_fixture(name, __VA_ARGS__, BENCHMARK_CXX_FLAGS)
+
+// Register a benchmark of func(args) for every combination of a Sweep
+#define BM_REGISTER_SWEEP(name, ...) \
+    static const bool BM_UNIQUE(bm_registered_) = ::bm::register_sweep(name, __VA_ARGS__, BENCHMARK_CXX_FLAGS)
+
+// Register a benchmark of body(state), with a fresh setup(args) state per iteration,
+// for every combination of a Sweep
+#define BM_REGISTER_SWEEP_FIXTURE(name, ...) \
+    static const bool BM_UNIQUE(bm_registered_) = ::bm::register_sweep_fixture(name, __VA_ARGS__, BENCHMARK_CXX_FLAGS)
+
+#endif // BENCHMARK_REGISTRY_HPP
@@ -0,0 +1,336 @@
+/*
+ *  Copyright 2016-present Daniel Trugman
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#ifndef BENCHMARK_REPORTER_HPP
+#define BENCHMARK_REPORTER_HPP
+
+#include <iostream>
+#include <iomanip>
+#include <memory>
+#include <limits>
+#include <string>
+
+#include "json.hpp"
+#include "runner.hpp"
+#include "context.hpp"
+
+namespace bm {
+
+// Every statistic of a result, per iteration where applicable
+struct Statistics
+{
+    explicit Statistics(const Result& result) :
+        iterations(result.mark.iterations()),
+        batches(result.batches),
+        threads(result.threads),
+        total_ns(result.mark.as_nanoseconds()),
+        min_ns(result.mark.minimal().as_nanoseconds()),
+        max_ns(result.mark.maximal().as_nanoseconds()),
+        avg_ns((iterations == 0) ? 0 : static_cast<double>(total_ns) / iterations),
+        stddev_ns(result.histogram.stddev()),
+        p50_ns(result.histogram.percentile(50)),
+        p90_ns(result.histogram.percentile(90)),
+        p99_ns(result.histogram.percentile(99)),
+        p999_ns(result.histogram.percentile(99.9)),
+        iterations_per_second((avg_ns == 0) ? 0 : 1e9 / avg_ns),
+        bytes(result.mark.bytes()),
+        items(result.mark.items()),
+        bytes_per_second(result.mark.bytes_per_second() * result.threads),
+        items_per_second(result.mark.items_per_second() * result.threads),
+        median_ns(stats::median(result.samples)),
+        mad_ns(stats::mad(result.samples)),
+        trimmed_mean_ns(stats::trimmed_mean(result.samples)),
+        iqr_ns(stats::iqr(result.samples)),
+        outliers(result.outliers),
+        allocations_per_iteration((iterations == 0) ? 0 : static_cast<double>(result.allocations) / iterations) {}
+
+    uint64_t iterations;
+    uint64_t batches;
+    unsigned threads;
+    int64_t  total_ns;
+    int64_t  min_ns;
+    int64_t  max_ns;
+    double   avg_ns;
+    // Of the histogram of samples, weighted by their iterations. A sample is a
+    // batch average unless every iteration is a batch of its own, as when
+    // capturing iterations or running cold, so batching hides the spread of
+    // single iterations and the tail percentiles are of batches, not latencies.
+    double   stddev_ns;
+    int64_t  p50_ns;
+    int64_t  p90_ns;
+    int64_t  p99_ns;
+    int64_t  p999_ns;
+    double   iterations_per_second; // Of a single thread
+    uint64_t bytes;
+    uint64_t items;
+    double   bytes_per_second;      // Of all threads together, as they ran concurrently
+    double   items_per_second;
+
+    // Robust estimators over the samples, i.e. batches or single iterations
+    double   median_ns;
+    double   mad_ns;
+    double   trimmed_mean_ns; // Of the middle 80%
+    double   iqr_ns;
+    uint64_t outliers;
+
+    double   allocations_per_iteration; // Only counted with BM_COUNT_ALLOCATIONS
+};
+
+// Receives results as soon as they are available
+class Reporter
+{
+public:
+    virtual ~Reporter() = default;
+
+    virtual void begin() {}
+    virtual void report(const Result& result) = 0;
+    virtual void summarize(const Report& report) { (void)report; } // Once all of its results were reported
+    virtual void end() {}
+};
+
+class ConsoleReporter : public Reporter
+{
+public:
+    ConsoleReporter(std::ostream& out, const Context& context) :
+        _out(out), _context(context) {}
+
+    void begin() override
+    {
+        if (_context.date.empty()) return;
+
+        _out << _context.date << " on " << _context.host << "\n"
+             << _context.cores << " x " << _context.cpu << " @ " << _context.mhz << "MHz"
+             << " (scaling: " << _context.scaling << ")\n"
+             << _context.compiler << " " << _context.flags << "\n"
+             << "Measured using " << _context.clock << "\n" << std::endl;
+    }
+
+    void report(const Result& result) override
+    {
+        _out << result << std::endl;
+    }
+
+    void summarize(const Report& report) override
+    {
+        for (const auto& scaling : report.scaling())
+        {
+            _out << report.name;
+            if (scaling.threads > 1)
+            {
+                _out << "/threads:" << scaling.threads;
+            }
+            _out << ": " << scaling.fit << std::endl;
+        }
+    }
+
+private:
+    std::ostream& _out;
+    Context       _context;
+};
+
+// A single JSON document, written incrementally:
+// { "context": {...}, "benchmarks": [ {"type": "result", ...}, {"type": "complexity", ...} ] }
+class JsonReporter : public Reporter
+{
+public:
+    JsonReporter(std::ostream& out, const Context& context) :
+        _out(out), _context(context), _first(true) {}
+
+    void begin() override
+    {
+        _precision = _out.precision(std::numeric_limits<double>::max_digits10);
+        _out << "{\n  \"context\": {"
+             << "\n    \"date\": "     << Json::escape(_context.date) << ","
+             << "\n    \"host\": "     << Json::escape(_context.host) << ","
+             << "\n    \"cpu\": "      << Json::escape(_context.cpu) << ","
+             << "\n    \"cores\": "    << _context.cores << ","
+             << "\n    \"mhz\": "      << _context.mhz << ","
+             << "\n    \"scaling\": "  << Json::escape(_context.scaling) << ","
+             << "\n    \"compiler\": " << Json::escape(_context.compiler) << ","
+             << "\n    \"flags\": "    << Json::escape(_context.flags) << ","
+             << "\n    \"clock\": "    << Json::escape(_context.clock)
+             << "\n  },\n  \"benchmarks\": [" << std::flush;
+    }
+
+    void report(const Result& result) override
+    {
+        Statistics stats(result);
+        separate();
+        _out << "\n    {"
+             << "\"type\": \"result\", "
+             << "\"id\": " << Json::escape(id(result)) << ", "
+             << "\"name\": " << Json::escape(result.name) << ", "
+             << "\"args\": [";
+        for (size_t i = 0; i < result.args.size(); ++i)
+        {
+            _out << (i ? ", " : "") << result.args[i];
+        }
+        _out << "], "
+             << "\"threads\": " << stats.threads << ", "
+             << "\"iterations\": " << stats.iterations << ", "
+             << "\"batches\": " << stats.batches << ", "
+             << "\"total_ns\": " << stats.total_ns << ", "
+             << "\"min_ns\": " << stats.min_ns << ", "
+             << "\"max_ns\": " << stats.max_ns << ", "
+             << "\"avg_ns\": " << stats.avg_ns << ", "
+             << "\"stddev_ns\": " << stats.stddev_ns << ", "
+             << "\"p50_ns\": " << stats.p50_ns << ", "
+             << "\"p90_ns\": " << stats.p90_ns << ", "
+             << "\"p99_ns\": " << stats.p99_ns << ", "
+             << "\"p999_ns\": " << stats.p999_ns << ", "
+             << "\"iterations_per_second\": " << stats.iterations_per_second << ", "
+             << "\"bytes\": " << stats.bytes << ", "
+             << "\"items\": " << stats.items << ", "
+             << "\"bytes_per_second\": " << stats.bytes_per_second << ", "
+             << "\"items_per_second\": " << stats.items_per_second << ", "
+             << "\"median_ns\": " << stats.median_ns << ", "
+             << "\"mad_ns\": " << stats.mad_ns << ", "
+             << "\"trimmed_mean_ns\": " << stats.trimmed_mean_ns << ", "
+             << "\"iqr_ns\": " << stats.iqr_ns << ", "
+             << "\"outliers\": " << stats.outliers << ", "
+             << "\"allocations_per_iteration\": " << stats.allocations_per_iteration
+             << "}" << std::flush;
+    }
+
+    void summarize(const Report& report) override
+    {
+        for (const auto& scaling : report.scaling())
+        {
+            separate();
+            _out << "\n    {"
+                 << "\"type\": \"complexity\", "
+                 << "\"name\": " << Json::escape(report.name) << ", "
+                 << "\"threads\": " << scaling.threads << ", "
+                 << "\"complexity\": " << Json::escape(to_string(scaling.fit.complexity)) << ", "
+                 << "\"coefficient\": " << scaling.fit.coefficient << ", "
+                 << "\"rms\": " << scaling.fit.rms
+                 << "}" << std::flush;
+        }
+    }
+
+    void end() override
+    {
+        _out << "\n  ]\n}\n" << std::flush;
+        _out.precision(_precision);
+    }
+
+private:
+    void separate()
+    {
+        if (!_first) _out << ",";
+        _first = false;
+    }
+
+private:
+    std::ostream&   _out;
+    Context         _context;
+    bool            _first;
+    std::streamsize _precision;
+};
+
+// One row per result, preceded by '#' comment lines holding the context
+class CsvReporter : public Reporter
+{
+public:
+    CsvReporter(std::ostream& out, const Context& context) :
+        _out(out), _context(context) {}
+
+    void begin() override
+    {
+        _precision = _out.precision(std::numeric_limits<double>::max_digits10);
+        _out << "# date: "     << _context.date     << "\n"
+             << "# host: "     << _context.host     << "\n"
+             << "# cpu: "      << _context.cpu      << "\n"
+             << "# cores: "    << _context.cores    << "\n"
+             << "# mhz: "      << _context.mhz      << "\n"
+             << "# scaling: "  << _context.scaling  << "\n"
+             << "# compiler: " << _context.compiler << "\n"
+             << "# flags: "    << _context.flags    << "\n"
+             << "# clock: "    << _context.clock    << "\n"
+             << "id,name,threads,iterations,batches,total_ns,min_ns,max_ns,avg_ns,stddev_ns,"
+                "p50_ns,p90_ns,p99_ns,p999_ns,iterations_per_second,"
+                "bytes,items,bytes_per_second,items_per_second,"
+                "median_ns,mad_ns,trimmed_mean_ns,iqr_ns,outliers,allocations_per_iteration"
+             << std::endl;
+    }
+
+    void report(const Result& result) override
+    {
+        Statistics stats(result);
+        _out << quote(id(result)) << ","
+             << quote(result.name) << ","
+             << stats.threads << ","
+             << stats.iterations << ","
+             << stats.batches << ","
+             << stats.total_ns << ","
+             << stats.min_ns << ","
+             << stats.max_ns << ","
+             << stats.avg_ns << ","
+             << stats.stddev_ns << ","
+             << stats.p50_ns << ","
+             << stats.p90_ns << ","
+             << stats.p99_ns << ","
+             << stats.p999_ns << ","
+             << stats.iterations_per_second << ","
+             << stats.bytes << ","
+             << stats.items << ","
+             << stats.bytes_per_second << ","
+             << stats.items_per_second << ","
+             << stats.median_ns << ","
+             << stats.mad_ns << ","
+             << stats.trimmed_mean_ns << ","
+             << stats.iqr_ns << ","
+             << stats.outliers << ","
+             << stats.allocations_per_iteration
+             << std::endl;
+    }
+
+    void end() override
+    {
+        _out.precision(_precision);
+    }
+
+private:
+    static std::string quote(const std::string& field)
+    {
+        std::string quoted("\"");
+        for (auto c : field)
+        {
+            if (c == '"') quoted += '"';
+            quoted += c;
+        }
+        return quoted + "\"";
+    }
+
+private:
+    std::ostream&   _out;
+    Context         _context;
+    std::streamsize _precision;
+};
+
+// A reporter by its name, nullptr if unknown
+inline std::unique_ptr<Reporter> make_reporter(const std::string& format, std::ostream& out,
+                                               const Context& context = Context())
+{
+    if (format == "console") return std::unique_ptr<Reporter>(new ConsoleReporter(out, context));
+    if (format == "json")    return std::unique_ptr<Reporter>(new JsonReporter(out, context));
+    if (format == "csv")     return std::unique_ptr<Reporter>(new CsvReporter(out, context));
+    return nullptr;
+}
+
+} // namespace bm
+
+#endif // BENCHMARK_REPORTER_HPP
@@ -0,0 +1,213 @@
+/*
+ *  Copyright 2016-present Daniel Trugman
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#ifndef BENCHMARK_RESOURCE_HPP
+#define BENCHMARK_RESOURCE_HPP
+
+#if defined __linux__ || defined __APPLE__
+#   define BENCHMARK_RUSAGE
+#endif
+
+#ifdef BENCHMARK_RUSAGE
+
+#include <sys/resource.h>
+
+#include <iostream>
+#include <cstdint>
+#include <utility>
+#include <chrono>
+
+#include "mark.hpp"
+
+namespace bm {
+
+// Whose resources are measured. Per-thread usage is only available on Linux.
+enum class ResourceScope { process, thread };
+
+// A getrusage() snapshot, or the difference between two
+struct Resources
+{
+    Resources() :
+        user(0), system(0),
+        voluntary_switches(0), involuntary_switches(0),
+        minor_faults(0), major_faults(0),
+        blocks_in(0), blocks_out(0) {}
+
+    Mark::nanoseconds user;
+    Mark::nanoseconds system;
+    int64_t           voluntary_switches;   // Blocked, e.g. waiting for I/O or a lock
+    int64_t           involuntary_switches; // Preempted by the scheduler
+    int64_t           minor_faults;         // Served without I/O
+    int64_t           major_faults;         // Required I/O, i.e. paging
+    int64_t           blocks_in;
+    int64_t           blocks_out;
+
+    static Resources now(ResourceScope scope = ResourceScope::process)
+    {
+        int who = RUSAGE_SELF;
+#ifdef RUSAGE_THREAD
+        if (scope == ResourceScope::thread) who = RUSAGE_THREAD;
+#else
+        (void)scope;
+#endif // RUSAGE_THREAD
+
+        struct rusage usage = {};
+        getrusage(who, &usage);
+
+        Resources resources;
+        resources.user                 = to_duration(usage.ru_utime);
+        resources.system               = to_duration(usage.ru_stime);
+        resources.voluntary_switches   = usage.ru_nvcsw;
+        resources.involuntary_switches = usage.ru_nivcsw;
+        resources.minor_faults         = usage.ru_minflt;
+        resources.major_faults         = usage.ru_majflt;
+        resources.blocks_in            = usage.ru_inblock;
+        resources.blocks_out           = usage.ru_oublock;
+        return resources;
+    }
+
+    Resources operator-(const Resources& rhs) const
+    {
+        Resources delta;
+        delta.user                 = user - rhs.user;
+        delta.system               = system - rhs.system;
+        delta.voluntary_switches   = voluntary_switches - rhs.voluntary_switches;
+        delta.involuntary_switches = involuntary_switches - rhs.involuntary_switches;
+        delta.minor_faults         = minor_faults - rhs.minor_faults;
+        delta.major_faults         = major_faults - rhs.major_faults;
+        delta.blocks_in            = blocks_in - rhs.blocks_in;
+        delta.blocks_out           = blocks_out - rhs.blocks_out;
+        return delta;
+    }
+
+private:
+    static Mark::nanoseconds to_duration(const struct timeval& tv)
+    {
+        return std::chrono::seconds(tv.tv_sec) + std::chrono::microseconds(tv.tv_usec);
+    }
+};
+
+// Aggregates resource deltas, one per iteration. CPU times are kept as Marks,
+// for their min/avg/max, the rest as totals.
+class ResourceMark
+{
+public: // Overloaded operators
+    ResourceMark& operator+=(const Resources& delta)
+    {
+        _user   += delta.user;
+        _system += delta.system;
+        _total.voluntary_switches   += delta.voluntary_switches;
+        _total.involuntary_switches += delta.involuntary_switches;
+        _total.minor_faults         += delta.minor_faults;
+        _total.major_faults         += delta.major_faults;
+        _total.blocks_in            += delta.blocks_in;
+        _total.blocks_out           += delta.blocks_out;
+        _total.user   += delta.user;
+        _total.system += delta.system;
+        return *this;
+    }
+
+    ResourceMark& operator+=(const ResourceMark& rhs)
+    {
+        _user   += rhs._user;
+        _system += rhs._system;
+        _total.voluntary_switches   += rhs._total.voluntary_switches;
+        _total.involuntary_switches += rhs._total.involuntary_switches;
+        _total.minor_faults         += rhs._total.minor_faults;
+        _total.major_faults         += rhs._total.major_faults;
+        _total.blocks_in            += rhs._total.blocks_in;
+        _total.blocks_out           += rhs._total.blocks_out;
+        _total.user   += rhs._total.user;
+        _total.system += rhs._total.system;
+        return *this;
+    }
+
+public: // Getters
+    int64_t iterations() const { return _user.iterations(); }
+
+    const Mark& user()   const { return _user; }
+    const Mark& system() const { return _system; }
+
+    // The sum of all deltas
+    const Resources& total() const { return _total; }
+
+public: // Methods
+    void clear()
+    {
+        _user.clear();
+        _system.clear();
+        _total = Resources();
+    }
+
+private: // Members
+    Mark      _user;
+    Mark      _system;
+    Resources _total;
+};
+
+inline std::ostream& operator<<(std::ostream& out, const ResourceMark& mark)
+{
+    const auto& total = mark.total();
+    out << mark.iterations() << " iterations"
+        << ", user " << total.user.count() << "ns"
+        << ", system " << total.system.count() << "ns"
+        << ", context switches " << total.voluntary_switches << " voluntary / "
+                                 << total.involuntary_switches << " involuntary"
+        << ", page faults " << total.minor_faults << " minor / " << total.major_faults << " major"
+        << ", blocks " << total.blocks_in << " in / " << total.blocks_out << " out";
+    return out;
+}
+
+// Adds the resources used within its scope to a ResourceMark
+class ResourceProbe
+{
+public:
+    ResourceProbe(ResourceMark & mark, ResourceScope scope = ResourceScope::process) :
+        _mark(mark), _scope(scope), _done(false), _before(Resources::now(scope)) {}
+    ~ResourceProbe() { done(); }
+
+    ResourceProbe(const ResourceProbe&) = delete;
+    ResourceProbe& operator=(const ResourceProbe&) = delete;
+
+    void done()
+    {
+        if (_done) return;
+
+        _mark += (Resources::now(_scope) - _before);
+        _done = true;
+    }
+
+private:
+    ResourceMark & _mark;
+    ResourceScope  _scope;
+    bool           _done;
+    Resources      _before;
+};
+
+// Call func(args...), adding the resources it used to the mark
+template < class Func, class... Args >
+auto mark_resources(ResourceMark& mark, Func&& func, Args&&... args)
+    -> decltype(std::forward<Func>(func)(std::forward<Args>(args)...))
+{
+    ResourceProbe probe(mark);
+    return std::forward<Func>(func)(std::forward<Args>(args)...);
+}
+
+} // namespace bm
+
+#endif // BENCHMARK_RUSAGE
+
+#endif // BENCHMARK_RESOURCE_HPP
@@ -0,0 +1,361 @@
+/*
+ *  Copyright 2016-present Daniel Trugman
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#ifndef BENCHMARK_RING_HPP
+#define BENCHMARK_RING_HPP
+
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+#include <thread>
+#include <chrono>
+#include <atomic>
+#include <mutex>
+#include <map>
+
+#include "mark.hpp"
+#include "histogram.hpp"
+
+namespace bm {
+
+// What a producer does when its ring is full
+enum class Backpressure
+{
+    drop,      // Discard the new sample
+    overwrite  // Discard the oldest sample
+};
+
+// A single producer, single consumer ring of raw samples.
+// Every slot is guarded by a sequence number (a per-slot seqlock), so the
+// consumer can detect a slot that the producer overwrote while it was read.
+class SampleRing
+{
+public: // Types
+    enum class Kind : uint32_t { duration, bytes, items };
+
+public: // C'tors
+    // The capacity is rounded up to a power of two
+    SampleRing(size_t capacity, Backpressure policy) :
+        _policy(policy), _mask(round_up(capacity) - 1), _slots(_mask + 1),
+        _head(0), _tail(0), _lost(0)
+    {
+        for (auto& slot : _slots) slot.sequence.store(0, std::memory_order_relaxed);
+    }
+
+    SampleRing(const SampleRing&) = delete;
+    SampleRing& operator=(const SampleRing&) = delete;
+
+public: // Producer
+    // Returns false if the sample was dropped
+    bool push(uint32_t id, Kind kind, int64_t value)
+    {
+        auto head = _head.load(std::memory_order_relaxed);
+        if (_policy == Backpressure::drop &&
+            head - _tail.load(std::memory_order_acquire) > _mask)
+        {
+            _lost.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+
+        auto& slot = _slots[head & _mask];
+        slot.sequence.store(2 * head + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        slot.key.store((static_cast<uint64_t>(id) << 2) | static_cast<uint64_t>(kind), std::memory_order_relaxed);
+        slot.value.store(value, std::memory_order_relaxed);
+        slot.sequence.store(2 * head + 2, std::memory_order_release);
+
+        _head.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+public: // Consumer
+    // Pass every available sample to consume(id, kind, value), oldest first
+    template < class Consume >
+    size_t drain(Consume&& consume)
+    {
+        auto head = _head.load(std::memory_order_acquire);
+        auto tail = _tail.load(std::memory_order_relaxed);
+
+        // Overwritten before they could be read
+        if (head - tail > _mask + 1)
+        {
+            _lost.fetch_add(head - tail - (_mask + 1), std::memory_order_relaxed);
+            tail = head - (_mask + 1);
+        }
+
+        size_t count = 0;
+        for (; tail != head; ++tail)
+        {
+            auto& slot = _slots[tail & _mask];
+            auto before = slot.sequence.load(std::memory_order_acquire);
+            auto key    = slot.key.load(std::memory_order_relaxed);
+            auto value  = slot.value.load(std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_acquire);
+            auto after  = slot.sequence.load(std::memory_order_relaxed);
+
+            if (before != after || before != 2 * tail + 2)
+            {
+                _lost.fetch_add(1, std::memory_order_relaxed);
+                continue;
+            }
+
+            consume(static_cast<uint32_t>(key >> 2), static_cast<Kind>(key & 3), value);
+            ++count;
+        }
+
+        _tail.store(tail, std::memory_order_release);
+        return count;
+    }
+
+public: // Getters
+    size_t capacity() const { return _mask + 1; }
+
+    // Samples dropped or overwritten so far
+    uint64_t lost() const { return _lost.load(std::memory_order_relaxed); }
+
+private: // Types
+    struct Slot
+    {
+        std::atomic<uint64_t> sequence; // Odd while being written
+        std::atomic<uint64_t> key;      // Id and kind
+        std::atomic<int64_t>  value;
+    };
+
+private: // Methods
+    static size_t round_up(size_t capacity)
+    {
+        size_t size = 1;
+        while (size < capacity) size *= 2;
+        return size;
+    }
+
+private: // Members
+    Backpressure          _policy;
+    size_t                _mask;
+    std::vector<Slot>     _slots;
+    char                  _pad0[64]; // The producer's and the consumer's indexes
+    std::atomic<uint64_t> _head;     // are kept on separate cache lines
+    char                  _pad1[64];
+    std::atomic<uint64_t> _tail;
+    char                  _pad2[64];
+    std::atomic<uint64_t> _lost;
+};
+
+// Aggregates samples that probes write into per-thread rings.
+// Probes only push (id, duration) into the calling thread's ring, and the
+// aggregator drains all rings into a Mark and a Histogram per channel,
+// either on demand or periodically from a background thread.
+class RingAggregator
+{
+public: // Types
+    class Sink;
+
+public: // C'tors
+    RingAggregator(size_t capacity = 4096, Backpressure policy = Backpressure::drop) :
+        _identity(next_identity()), _capacity(capacity), _policy(policy), _running(false) {}
+
+    ~RingAggregator() { stop(); }
+
+    RingAggregator(const RingAggregator&) = delete;
+    RingAggregator& operator=(const RingAggregator&) = delete;
+
+public: // Methods
+    // A sink for probes, e.g. Bench::BasicProbe<RingAggregator::Sink>
+    Sink channel(const std::string& name);
+
+    // Drain all rings into the channels' Marks and Histograms
+    void drain()
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        for (auto& ring : _rings)
+        {
+            ring.second->drain([this](uint32_t id, SampleRing::Kind kind, int64_t value) {
+                if (id >= _channels.size()) return;
+
+                auto& channel = _channels[id];
+                switch (kind)
+                {
+                    case SampleRing::Kind::duration:
+                        channel.mark += Mark::nanoseconds(value);
+                        channel.histogram.add(value);
+                        break;
+                    case SampleRing::Kind::bytes:
+                        channel.mark.add_bytes(static_cast<uint64_t>(value));
+                        break;
+                    case SampleRing::Kind::items:
+                        channel.mark.add_items(static_cast<uint64_t>(value));
+                        break;
+                }
+            });
+        }
+    }
+
+    // Drain periodically from a background thread, until stopped
+    void start(Mark::nanoseconds interval)
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (_running) return;
+
+        _running = true;
+        _thread = std::thread([this, interval]() {
+            std::unique_lock<std::mutex> lock(_mutex);
+            while (!_wakeup.wait_for(lock, interval, [this]() { return !_running; }))
+            {
+                lock.unlock();
+                drain();
+                lock.lock();
+            }
+        });
+    }
+
+    // Stop draining in the background, after a final drain
+    void stop()
+    {
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            if (!_running) return;
+
+            _running = false;
+        }
+        _wakeup.notify_all();
+        _thread.join();
+
+        drain();
+    }
+
+public: // Getters
+    // Copies, as the aggregator may be draining concurrently
+    Mark mark(const Sink& sink) const;
+    Histogram histogram(const Sink& sink) const;
+
+    // Samples dropped or overwritten, in all rings
+    uint64_t lost() const
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        uint64_t lost = 0;
+        for (const auto& ring : _rings) lost += ring.second->lost();
+        return lost;
+    }
+
+private: // Types
+    struct Channel
+    {
+        std::string name;
+        Mark        mark;
+        Histogram   histogram;
+    };
+
+    // The calling thread's ring of the last aggregator it pushed into
+    struct Cache
+    {
+        uint64_t    identity;
+        SampleRing* ring;
+    };
+
+private: // Methods
+    static uint64_t next_identity()
+    {
+        static std::atomic<uint64_t> identity(0);
+        return ++identity;
+    }
+
+    SampleRing& ring()
+    {
+        static thread_local Cache cache = { 0, nullptr };
+        if (cache.identity == _identity) return *cache.ring;
+
+        std::lock_guard<std::mutex> lock(_mutex);
+        auto& ring = _rings[std::this_thread::get_id()];
+        if (!ring) ring.reset(new SampleRing(_capacity, _policy));
+
+        cache.identity = _identity;
+        cache.ring = ring.get();
+        return *ring;
+    }
+
+private: // Members
+    uint64_t                _identity; // Unique, unlike the address
+    size_t                  _capacity;
+    Backpressure            _policy;
+    mutable std::mutex      _mutex;
+    std::condition_variable _wakeup;
+    bool                    _running;
+    std::thread             _thread;
+    std::vector<Channel>    _channels;
+
+    // Rings outlive their threads, so nothing pushed is lost
+    std::map<std::thread::id, std::unique_ptr<SampleRing>> _rings;
+};
+
+// Records into the calling thread's ring, with the interface of a Mark
+class RingAggregator::Sink
+{
+public:
+    template < class Rep, class Period >
+    Sink& operator+=(const std::chrono::duration<Rep, Period>& duration)
+    {
+        auto ns = std::chrono::duration_cast<Mark::nanoseconds>(duration).count();
+        _aggregator->ring().push(_id, SampleRing::Kind::duration, ns);
+        return *this;
+    }
+
+    Sink& add_bytes(uint64_t bytes)
+    {
+        _aggregator->ring().push(_id, SampleRing::Kind::bytes, static_cast<int64_t>(bytes));
+        return *this;
+    }
+
+    Sink& add_items(uint64_t items)
+    {
+        _aggregator->ring().push(_id, SampleRing::Kind::items, static_cast<int64_t>(items));
+        return *this;
+    }
+
+private:
+    friend class RingAggregator;
+
+    Sink(RingAggregator& aggregator, uint32_t id) : _aggregator(&aggregator), _id(id) {}
+
+    RingAggregator* _aggregator;
+    uint32_t        _id;
+};
+
+inline RingAggregator::Sink RingAggregator::channel(const std::string& name)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    Channel channel;
+    channel.name = name;
+    _channels.push_back(std::move(channel));
+    return Sink(*this, static_cast<uint32_t>(_channels.size() - 1));
+}
+
+inline Mark RingAggregator::mark(const Sink& sink) const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _channels[sink._id].mark;
+}
+
+inline Histogram RingAggregator::histogram(const Sink& sink) const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _channels[sink._id].histogram;
+}
+
+} // namespace bm
+
+#endif // BENCHMARK_RING_HPP
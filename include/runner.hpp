@@ -0,0 +1,809 @@
+/*
+ *  Copyright 2016-present Daniel Trugman
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#ifndef BENCHMARK_RUNNER_HPP
+#define BENCHMARK_RUNNER_HPP
+
+#include <type_traits>
+#include <functional>
+#include <algorithm>
+#include <iostream>
+#include <utility>
+#include <cstdint>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <thread>
+#include <chrono>
+
+#include "mark.hpp"
+#include "cache.hpp"
+#include "histogram.hpp"
+#include "counters.hpp"
+#include "complexity.hpp"
+#include "statistics.hpp"
+#include "thread_clock.hpp"
+#include "process_clock.hpp"
+
+namespace bm {
+
+// Keep the compiler from optimizing away a value computed by a benchmark
+template < class T >
+inline void do_not_optimize(T const& value)
+{
+#if defined __GNUC__ || defined __clang__
+    asm volatile("" : : "r,m"(value) : "memory");
+#else
+    static volatile const void* sink;
+    sink = &value;
+#endif
+}
+
+namespace detail {
+
+// Call func(args...) and keep its result, if any, from being optimized away
+template < class Func, class... Params >
+auto invoke(Func& func, Params&... args)
+    -> typename std::enable_if<std::is_void<decltype(func(args...))>::value>::type
+{
+    func(args...);
+}
+
+template < class Func, class... Params >
+auto invoke(Func& func, Params&... args)
+    -> typename std::enable_if<!std::is_void<decltype(func(args...))>::value>::type
+{
+    do_not_optimize(func(args...));
+}
+
+} // namespace detail
+
+struct Options
+{
+    // What every sample of a result stands for
+    enum class Capture
+    {
+        batches,   // The per-iteration average of a batch
+        iterations // A single iteration, i.e. every iteration is timed on its own
+    };
+
+    // The state of the caches an iteration starts with
+    enum class Cache
+    {
+        warm, // Whatever the previous iterations left behind
+        cold  // Evicted ahead of every iteration, which is timed on its own
+    };
+
+    Options() :
+        min_time(std::chrono::milliseconds(100)),
+        batch_time(std::chrono::microseconds(200)),
+        max_batch(4096),
+        iterations(0),
+        threads(1),
+        capture(Capture::batches),
+        reject_outliers(false),
+        fence(1.5),
+        cache(Cache::warm),
+        cold_iterations(50) {}
+
+    Mark::nanoseconds min_time;        // Keep running batches until this much time was measured
+    Mark::nanoseconds batch_time;      // Target duration of a single timed batch
+    size_t            max_batch;       // Upper bound on the iterations (and fixtures) of a batch
+    uint64_t          iterations;      // Exact number of iterations to run, 0 means use min_time
+    unsigned          threads;         // Number of threads running concurrently, each on its own
+    Capture           capture;
+    bool              reject_outliers; // Drop samples outside the Tukey fences before reporting
+    double            fence;           // The k of the Tukey fences
+    Cache             cache;
+    uint64_t          cold_iterations; // Iterations of a cold run, unless iterations is set
+    std::function<void()> evict;       // Evicts the caches of a cold run, a cache::Evictor if empty
+};
+
+inline const char* to_string(Options::Cache cache)
+{
+    switch (cache)
+    {
+        case Options::Cache::warm: return "warm";
+        case Options::Cache::cold: return "cold";
+    }
+    return "unknown";
+}
+
+// Benchmark arguments, e.g. the input size
+using Args = std::vector<int64_t>;
+
+// lo, lo * multiplier, lo * multiplier^2, ... and hi.
+// Stops before a multiplication could overflow, i.e. once the next value would exceed hi.
+inline std::vector<int64_t> range(int64_t lo, int64_t hi, int64_t multiplier = 8)
+{
+    auto factor = (std::max)(multiplier, static_cast<int64_t>(2));
+
+    std::vector<int64_t> values;
+    for (auto value = lo; value < hi; value *= factor)
+    {
+        values.push_back(value);
+        if (value <= 0 || value > hi / factor) break;
+    }
+    values.push_back(hi);
+    return values;
+}
+
+// lo, lo + step, lo + 2 * step, ... up to hi, without overflowing past it
+inline std::vector<int64_t> dense_range(int64_t lo, int64_t hi, int64_t step = 1)
+{
+    auto increment = (std::max)(step, static_cast<int64_t>(1));
+
+    std::vector<int64_t> values;
+    for (auto value = lo; value <= hi; value += increment)
+    {
+        values.push_back(value);
+
+        // hi - value, computed without overflow
+        if (static_cast<uint64_t>(hi) - static_cast<uint64_t>(value) < static_cast<uint64_t>(increment)) break;
+    }
+    return values;
+}
+
+// The cartesian product of the given argument values
+inline std::vector<Args> product(const std::vector<std::vector<int64_t>>& dimensions)
+{
+    std::vector<Args> combinations(1);
+    for (const auto& dimension : dimensions)
+    {
+        std::vector<Args> extended;
+        for (const auto& combination : combinations)
+        {
+            for (auto value : dimension)
+            {
+                extended.push_back(combination);
+                extended.back().push_back(value);
+            }
+        }
+        combinations.swap(extended);
+    }
+    return combinations;
+}
+
+// Every combination of args is run with every thread count
+struct Sweep
+{
+    Sweep() : threads(1, 1) {}
+
+    std::vector<Args>     args;
+    std::vector<unsigned> threads;
+};
+
+struct Result
+{
+    Result() : batches(0), threads(1), outliers(0), allocations(0) {}
+
+    std::string name;
+    Mark        mark;    // Min/Max hold the per-iteration averages of the batches
+    uint64_t    batches;
+    Args        args;
+    unsigned    threads;
+    uint64_t    outliers;    // Batches rejected by Options::reject_outliers
+    uint64_t    allocations; // Heap allocations within the timed regions, see allocations.hpp
+
+    Histogram           histogram; // Per-iteration averages of the batches, weighted by iterations
+    std::vector<double> samples;   // Per-iteration nanoseconds of every batch
+};
+
+// A unique identifier of a result, i.e. its name, arguments and thread count
+inline std::string id(const Result& result)
+{
+    std::ostringstream out;
+    out << result.name;
+    for (auto arg : result.args)
+    {
+        out << "/" << arg;
+    }
+    if (result.threads > 1)
+    {
+        out << "/threads:" << result.threads;
+    }
+    return out.str();
+}
+
+// Account for a batch of iterations that were timed together
+template < class Rep, class Period >
+void record(Result& result, const std::chrono::duration<Rep, Period>& duration, uint64_t iterations)
+{
+    if (iterations == 0) return;
+
+    auto ns = std::chrono::duration_cast<Mark::nanoseconds>(duration).count();
+    result.mark.add_batch(duration, iterations);
+    result.histogram.add(ns / static_cast<int64_t>(iterations), iterations);
+    result.samples.push_back(static_cast<double>(ns) / iterations);
+    ++result.batches;
+}
+
+// A timed batch: its iterations, and what they counted
+struct Batch
+{
+    uint64_t iterations;
+    Counters counted;
+};
+
+// Account for whatever was counted since the given snapshot of this thread's counters,
+// and return it
+inline Counters record(Result& result, const Counters& snapshot)
+{
+    const auto& counters = Counters::current();
+    Counters counted = {
+        counters.bytes - snapshot.bytes,
+        counters.items - snapshot.items,
+        counters.allocations - snapshot.allocations };
+
+    result.mark.add_bytes(counted.bytes);
+    result.mark.add_items(counted.items);
+    result.allocations += counted.allocations;
+    return counted;
+}
+
+// Aggregate another run of the same benchmark, e.g. another thread or repetition
+inline void merge(Result& into, const Result& from)
+{
+    into.mark      += from.mark;
+    into.batches   += from.batches;
+    into.histogram += from.histogram;
+    into.samples.insert(into.samples.end(), from.samples.begin(), from.samples.end());
+    into.outliers  += from.outliers;
+    into.allocations += from.allocations;
+}
+
+// Drop the batches whose samples lie outside the Tukey fences, along with
+// what they counted, and aggregate the rest anew. batches holds the batch
+// of every sample.
+inline void reject_outliers(Result& result, const std::vector<Batch>& batches, double k)
+{
+    if (result.samples.size() < 4 || result.samples.size() != batches.size()) return;
+
+    auto fences = stats::tukey_fences(result.samples, k);
+
+    Mark mark;
+    uint64_t allocations = 0;
+    Histogram histogram;
+    std::vector<double> samples;
+    samples.reserve(result.samples.size());
+
+    for (size_t i = 0; i < result.samples.size(); ++i)
+    {
+        auto sample = result.samples[i];
+        if (!fences.contain(sample))
+        {
+            ++result.outliers;
+            continue;
+        }
+
+        const auto& batch = batches[i];
+        auto ns = static_cast<int64_t>(std::llround(sample * batch.iterations));
+        mark.add_batch(Mark::nanoseconds(ns), batch.iterations);
+        mark.add_bytes(batch.counted.bytes);
+        mark.add_items(batch.counted.items);
+        allocations += batch.counted.allocations;
+        histogram.add(static_cast<int64_t>(std::llround(sample)), batch.iterations);
+        samples.push_back(sample);
+    }
+
+    result.mark = mark;
+    result.allocations = allocations;
+    result.histogram = histogram;
+    result.samples.swap(samples);
+    result.batches = result.samples.size();
+}
+
+inline std::ostream& operator<<(std::ostream& out, const Result& result)
+{
+    out << id(result) << ": "
+        << result.mark.average().as_nanoseconds() << "ns per iteration"
+        << " (min " << result.mark.minimal().as_nanoseconds() << "ns"
+        << ", max " << result.mark.maximal().as_nanoseconds() << "ns)"
+        << " after " << result.mark.iterations() << " iterations"
+        << " in " << result.batches << " batches";
+
+    if (result.outliers != 0)
+    {
+        out << " (" << result.outliers << " outliers rejected)";
+    }
+    if (result.allocations != 0 && result.mark.iterations() != 0)
+    {
+        out << ", " << static_cast<double>(result.allocations) / result.mark.iterations()
+            << " allocations per iteration";
+    }
+
+    // Rates of all threads together, as they ran concurrently
+    if (result.mark.bytes() != 0)
+    {
+        out << ", " << result.mark.bytes_per_second() * result.threads / 1e6 << "MB/s";
+    }
+    if (result.mark.items() != 0)
+    {
+        out << ", " << result.mark.items_per_second() * result.threads << " items/s";
+        if (result.mark.items() != static_cast<uint64_t>(result.mark.iterations()))
+        {
+            out << " (" << static_cast<double>(result.mark.as_nanoseconds()) / result.mark.items()
+                << "ns per item)";
+        }
+    }
+    return out;
+}
+
+// How a benchmark scales with its first argument, for a certain thread count
+struct Scaling
+{
+    Scaling() : threads(1) {}
+
+    unsigned threads;
+    Fit      fit;
+};
+
+// The results of a sweep and their complexity fits
+struct Report
+{
+    std::string         name;
+    std::vector<Result> results;
+
+    std::vector<Scaling> scaling() const
+    {
+        std::vector<Scaling> scalings;
+        std::vector<unsigned> threads;
+        for (const auto& result : results)
+        {
+            if (std::find(threads.begin(), threads.end(), result.threads) == threads.end())
+            {
+                threads.push_back(result.threads);
+            }
+        }
+
+        for (auto count : threads)
+        {
+            std::vector<std::pair<double, double>> samples;
+            for (const auto& result : results)
+            {
+                if (result.threads != count || result.args.empty()) continue;
+
+                samples.emplace_back(static_cast<double>(result.args.front()),
+                                     static_cast<double>(result.mark.average().as_nanoseconds()));
+            }
+
+            if (samples.size() < 2) continue;
+
+            Scaling scaling;
+            scaling.threads = count;
+            scaling.fit = fit(samples);
+            scalings.push_back(scaling);
+        }
+        return scalings;
+    }
+};
+
+inline std::ostream& operator<<(std::ostream& out, const Report& report)
+{
+    for (const auto& result : report.results)
+    {
+        out << result << "\n";
+    }
+    for (const auto& scaling : report.scaling())
+    {
+        out << report.name;
+        if (scaling.threads > 1)
+        {
+            out << "/threads:" << scaling.threads;
+        }
+        out << ": " << scaling.fit << "\n";
+    }
+    return out;
+}
+
+// The results of a benchmark with cold and with warm caches, in the same
+// order, their names tagged accordingly, e.g. sort/cold and sort/warm
+struct CacheReport
+{
+    Report cold;
+    Report warm;
+};
+
+inline std::ostream& operator<<(std::ostream& out, const CacheReport& report)
+{
+    auto count = (std::min)(report.cold.results.size(), report.warm.results.size());
+    for (size_t i = 0; i < count; ++i)
+    {
+        const auto& cold = report.cold.results[i];
+        const auto& warm = report.warm.results[i];
+        out << cold << "\n" << warm << "\n";
+
+        auto warm_ns = warm.mark.average().as_nanoseconds();
+        if (warm_ns != 0)
+        {
+            out << "  cold/warm: "
+                << static_cast<double>(cold.mark.average().as_nanoseconds()) / warm_ns << "x\n";
+        }
+    }
+    return out;
+}
+
+// Run a benchmark with cold caches, then with warm ones.
+// run(opts) returns the report of a single run with the given options.
+template < class Run >
+CacheReport cold_and_warm(const Options& opts, Run run)
+{
+    auto tagged = [&](Options::Cache cache) {
+        auto current = opts;
+        current.cache = cache;
+
+        Report report = run(current);
+        auto suffix = std::string("/") + to_string(cache);
+        report.name += suffix;
+        for (auto& result : report.results)
+        {
+            result.name += suffix;
+        }
+        return report;
+    };
+
+    CacheReport report;
+    report.cold = tagged(Options::Cache::cold);
+    report.warm = tagged(Options::Cache::warm);
+    return report;
+}
+
+template < class Clock >
+class GenericRunner
+{
+public:
+    template< class T >
+    using decay_type = typename std::decay<T>::type;
+
+public:
+    GenericRunner() = delete;
+
+public:
+    // Time func() repeatedly, in batches that are long enough
+    // for the clock overhead to be negligible.
+    // With several threads, each runs the requested iterations.
+    template < class Func >
+    static Result run(const std::string& name, Func&& func, const Options& opts = Options())
+    {
+        return parallel(opts, [&]() { return run_single(name, func, opts); });
+    }
+
+    // Time body(state) only. Every iteration gets a fresh state from setup(),
+    // which is handed to teardown(state) afterwards. States are prepared in
+    // bulk ahead of every batch, so the clock is read twice per batch only.
+    template < class Setup, class Body, class Teardown >
+    static Result fixture(const std::string& name,
+                          Setup&& setup, Body&& body, Teardown&& teardown,
+                          const Options& opts = Options())
+    {
+        return parallel(opts, [&]() { return fixture_single(name, setup, body, teardown, opts); });
+    }
+
+    // Run func() with cold caches, then with warm ones, see Options::Cache
+    template < class Func >
+    static CacheReport cold_warm(const std::string& name, Func&& func, const Options& opts = Options())
+    {
+        return cold_and_warm(opts, [&](const Options& current) {
+            Report report;
+            report.name = name;
+            report.results.push_back(run(name, func, current));
+            return report;
+        });
+    }
+
+    // Run func(args) for every combination of the sweep
+    template < class Func >
+    static Report sweep(const std::string& name, const Sweep& sweep, Func&& func,
+                        const Options& opts = Options())
+    {
+        return sweep_each(name, sweep, opts, [&](const Args& args, const Options& current) {
+            return run(name, [&]() { return func(args); }, current);
+        });
+    }
+
+    // Run a fixture for every combination of the sweep, using setup(args)
+    template < class Setup, class Body, class Teardown >
+    static Report sweep_fixture(const std::string& name, const Sweep& sweep,
+                                Setup&& setup, Body&& body, Teardown&& teardown,
+                                const Options& opts = Options())
+    {
+        return sweep_each(name, sweep, opts, [&](const Args& args, const Options& current) {
+            return fixture(name, [&]() { return setup(args); }, body, teardown, current);
+        });
+    }
+
+private:
+    template < class Func >
+    static Result run_single(const std::string& name, Func& func, const Options& opts)
+    {
+        int64_t estimate = 0;
+        auto batch = calibrate([&](size_t iterations) {
+            auto before = Clock::now();
+            for (size_t i = 0; i < iterations; ++i)
+            {
+                detail::invoke(func);
+            }
+            return Clock::now() - before;
+        }, opts, estimate);
+
+        Result result;
+        result.name = name;
+
+        std::vector<Batch> batches;
+        prepare(result, batches, batch, estimate, opts);
+
+        while (!finished(result.mark, opts))
+        {
+            auto iterations = next_batch(result.mark, batch, opts);
+
+            cool(opts);
+            auto counted = Counters::current();
+            auto before = Clock::now();
+            for (size_t i = 0; i < iterations; ++i)
+            {
+                detail::invoke(func);
+            }
+            auto after = Clock::now();
+            Batch timed = { static_cast<uint64_t>(iterations), record(result, counted) };
+
+            record(result, after - before, iterations);
+            batches.push_back(timed);
+        }
+
+        conclude(result, batches, opts);
+        return result;
+    }
+
+    template < class Setup, class Body, class Teardown >
+    static Result fixture_single(const std::string& name,
+                                 Setup& setup, Body& body, Teardown& teardown,
+                                 const Options& opts)
+    {
+        using state_type = decay_type<decltype(setup())>;
+
+        int64_t estimate = 0;
+        auto batch = calibrate([&](size_t iterations) {
+            std::vector<state_type> states;
+            states.reserve(iterations);
+            for (size_t i = 0; i < iterations; ++i)
+            {
+                states.emplace_back(setup());
+            }
+
+            auto before = Clock::now();
+            for (auto& state : states)
+            {
+                detail::invoke(body, state);
+            }
+            auto after = Clock::now();
+
+            for (auto& state : states)
+            {
+                teardown(state);
+            }
+            return after - before;
+        }, opts, estimate);
+
+        Result result;
+        result.name = name;
+
+        std::vector<Batch> batches;
+        prepare(result, batches, batch, estimate, opts);
+
+        std::vector<state_type> states;
+        states.reserve(batch);
+
+        while (!finished(result.mark, opts))
+        {
+            auto iterations = next_batch(result.mark, batch, opts);
+
+            for (size_t i = 0; i < iterations; ++i)
+            {
+                states.emplace_back(setup());
+            }
+
+            cool(opts);
+            auto counted = Counters::current();
+            auto before = Clock::now();
+            for (auto& state : states)
+            {
+                detail::invoke(body, state);
+            }
+            auto after = Clock::now();
+            Batch timed = { static_cast<uint64_t>(iterations), record(result, counted) };
+
+            for (auto& state : states)
+            {
+                teardown(state);
+            }
+            states.clear();
+
+            record(result, after - before, iterations);
+            batches.push_back(timed);
+        }
+
+        conclude(result, batches, opts);
+        return result;
+    }
+
+    template < class Single >
+    static Result parallel(const Options& opts, Single single)
+    {
+        if (opts.threads <= 1) return single();
+
+        std::vector<Result> results(opts.threads);
+        std::vector<std::thread> threads;
+        for (unsigned i = 0; i < opts.threads; ++i)
+        {
+            threads.emplace_back([&results, &single, i]() { results[i] = single(); });
+        }
+        for (auto& thread : threads)
+        {
+            thread.join();
+        }
+
+        Result merged = results.front();
+        for (size_t i = 1; i < results.size(); ++i)
+        {
+            merge(merged, results[i]);
+        }
+        merged.threads = opts.threads;
+        return merged;
+    }
+
+    template < class Each >
+    static Report sweep_each(const std::string& name, const Sweep& sweep,
+                             const Options& opts, Each each)
+    {
+        Report report;
+        report.name = name;
+
+        auto combinations = sweep.args.empty() ? std::vector<Args>(1) : sweep.args;
+        for (auto threads : sweep.threads)
+        {
+            for (const auto& args : combinations)
+            {
+                auto current = opts;
+                current.threads = threads;
+
+                auto result = each(args, current);
+                result.args = args;
+                result.threads = threads;
+                report.results.push_back(std::move(result));
+            }
+        }
+        return report;
+    }
+
+    // Run a warm-up iteration, which pays for page faults, first allocations
+    // and the like, and throw it away. Then time batches of 1, 2, 4, ...
+    // iterations until one lasts a tenth of batch_time, and size the batch
+    // from it. Every iteration is a batch of its own when capturing
+    // iterations or running cold.
+    template < class Timed >
+    static size_t calibrate(Timed timed, const Options& opts, int64_t& estimate)
+    {
+        int64_t elapsed = std::chrono::duration_cast<Mark::nanoseconds>(timed(1)).count();
+        if (opts.capture == Options::Capture::iterations ||
+            opts.cache == Options::Cache::cold)
+        {
+            estimate = (std::max)(elapsed, static_cast<int64_t>(1));
+            return 1;
+        }
+
+        // No more iterations than will be run, which matters for slow fixtures
+        auto max_batch = (std::max)(opts.max_batch, static_cast<size_t>(1));
+        if (opts.iterations != 0 && opts.iterations < max_batch)
+        {
+            max_batch = static_cast<size_t>(opts.iterations);
+        }
+
+        size_t iterations = 1;
+        while (true)
+        {
+            elapsed = std::chrono::duration_cast<Mark::nanoseconds>(timed(iterations)).count();
+            if (elapsed * 10 >= opts.batch_time.count() || iterations >= max_batch) break;
+
+            iterations = (std::min)(iterations * 2, max_batch);
+        }
+
+        estimate = (std::max)(elapsed / static_cast<int64_t>(iterations), static_cast<int64_t>(1));
+        if (elapsed <= 0) return max_batch;
+
+        auto batch = static_cast<double>(opts.batch_time.count()) * iterations / elapsed;
+        return static_cast<size_t>((std::min)((std::max)(batch, 1.0), static_cast<double>(max_batch)));
+    }
+
+    // Preallocate the samples for the planned batches, so capturing them
+    // does not allocate while timing. The planned count is estimated when
+    // running for min_time, and bounded by max_planned_samples.
+    static void prepare(Result& result, std::vector<Batch>& batches,
+                        size_t batch, int64_t estimate, const Options& opts)
+    {
+        static const uint64_t max_planned_samples = 1 << 22;
+
+        auto iterations = planned_iterations(opts);
+        uint64_t planned = (iterations != 0)
+            ? (iterations + batch - 1) / batch
+            : static_cast<uint64_t>(opts.min_time.count() / (estimate * static_cast<int64_t>(batch))) + 1;
+        planned = (std::min)(planned, max_planned_samples);
+
+        result.samples.reserve(static_cast<size_t>(planned));
+        batches.reserve(static_cast<size_t>(planned));
+    }
+
+    static void conclude(Result& result, const std::vector<Batch>& batches, const Options& opts)
+    {
+        if (opts.reject_outliers) reject_outliers(result, batches, opts.fence);
+    }
+
+    // Evict the caches ahead of a cold iteration
+    static void cool(const Options& opts)
+    {
+        if (opts.cache != Options::Cache::cold) return;
+
+        if (opts.evict)
+        {
+            opts.evict();
+        }
+        else
+        {
+            cache::default_evictor()();
+        }
+    }
+
+    // The exact number of iterations to run, 0 means use min_time.
+    // Cold runs are bounded, as evicting the caches takes much longer than most iterations.
+    static uint64_t planned_iterations(const Options& opts)
+    {
+        if (opts.iterations != 0 || opts.cache != Options::Cache::cold) return opts.iterations;
+        return (std::max)(opts.cold_iterations, static_cast<uint64_t>(1));
+    }
+
+    static bool finished(const Mark& mark, const Options& opts)
+    {
+        auto iterations = planned_iterations(opts);
+        if (iterations != 0)
+        {
+            return static_cast<uint64_t>(mark.iterations()) >= iterations;
+        }
+
+        return mark.iterations() != 0 && mark.as_nanoseconds() >= opts.min_time.count();
+    }
+
+    static size_t next_batch(const Mark& mark, size_t batch, const Options& opts)
+    {
+        auto iterations = planned_iterations(opts);
+        if (iterations == 0) return batch;
+
+        auto remaining = iterations - static_cast<uint64_t>(mark.iterations());
+        return static_cast<size_t>((std::min)(remaining, static_cast<uint64_t>(batch)));
+    }
+};
+
+using Runner = GenericRunner<std::chrono::steady_clock>;
+
+#ifdef BENCHMARK_THREAD_CPUTIME
+    using ThreadRunner = GenericRunner<thread_clock>;
+#endif // BENCHMARK_THREAD_CPUTIME
+
+#ifdef BENCHMARK_PROCESS_CPUTIME
+    using ProcessRunner = GenericRunner<process_clock>;
+#endif // BENCHMARK_PROCESS_CPUTIME
+
+} // namespace bm
+
+#endif // BENCHMARK_RUNNER_HPP
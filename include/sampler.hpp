@@ -0,0 +1,134 @@
+/*
+ *  Copyright 2016-present Daniel Trugman
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#ifndef BENCHMARK_SAMPLER_HPP
+#define BENCHMARK_SAMPLER_HPP
+
+#include "thread_clock.hpp"
+
+#ifdef BENCHMARK_THREAD_CPUTIME
+
+#include <string>
+#include <vector>
+#include <thread>
+#include <chrono>
+
+#include "mark.hpp"
+
+namespace bm {
+
+// Samples the CPU time of worker threads from the outside, without probes
+// in the workers' code. Every sample() adds each worker's CPU time since the
+// previous sample to its Mark, and updates its utilization over that period,
+// so hot (busy) and starved (idle) workers stand out.
+class ThreadSampler
+{
+public: // Types
+    using clock = std::chrono::steady_clock;
+
+    struct Worker
+    {
+        std::string name;
+        Mark        mark;
+        double      utilization; // CPU time over wall time of the last period
+        bool        alive;       // False once its CPU time can no longer be read
+
+    private:
+        friend class ThreadSampler;
+
+        Worker(const std::string& name, const ThreadCpuClock& cpu) :
+            name(name), utilization(0), alive(cpu.valid()), cpu(cpu) {}
+
+        ThreadCpuClock           cpu;
+        thread_clock::time_point last;
+        clock::time_point        last_wall;
+    };
+
+public: // Methods
+    // Returns false if the thread's CPU clock is unavailable
+    bool add(const std::string& name, pthread_t thread)
+    {
+        Worker worker(name, ThreadCpuClock(thread));
+        if (!worker.alive || !worker.cpu.now(worker.last)) return false;
+
+        worker.last_wall = clock::now();
+        _workers.push_back(std::move(worker));
+        return true;
+    }
+
+    bool add(const std::string& name, std::thread& thread)
+    {
+        return add(name, thread.native_handle());
+    }
+
+    void sample()
+    {
+        for (auto& worker : _workers)
+        {
+            if (!worker.alive) continue;
+
+            thread_clock::time_point cpu;
+            if (!worker.cpu.now(cpu))
+            {
+                worker.alive = false;
+                worker.utilization = 0;
+                continue;
+            }
+
+            auto now = clock::now();
+            auto wall = std::chrono::duration_cast<Mark::nanoseconds>(now - worker.last_wall).count();
+            auto used = cpu - worker.last;
+            worker.last = cpu;
+            worker.last_wall = now;
+            worker.mark += used;
+            worker.utilization = (wall <= 0) ? 0 : static_cast<double>(used.count()) / wall;
+        }
+    }
+
+public: // Getters
+    const std::vector<Worker>& workers() const { return _workers; }
+
+    // Live workers whose last utilization is at least the threshold, e.g. 0.9
+    std::vector<const Worker*> hot(double threshold) const
+    {
+        std::vector<const Worker*> result;
+        for (const auto& worker : _workers)
+        {
+            if (worker.alive && worker.utilization >= threshold) result.push_back(&worker);
+        }
+        return result;
+    }
+
+    // Live workers whose last utilization is at most the threshold, e.g. 0.1
+    std::vector<const Worker*> starved(double threshold) const
+    {
+        std::vector<const Worker*> result;
+        for (const auto& worker : _workers)
+        {
+            if (worker.alive && worker.utilization <= threshold) result.push_back(&worker);
+        }
+        return result;
+    }
+
+private: // Members
+    std::vector<Worker> _workers;
+};
+
+} // namespace bm
+
+#endif // BENCHMARK_THREAD_CPUTIME
+
+#endif // BENCHMARK_SAMPLER_HPP
@@ -0,0 +1,194 @@
+/*
+ *  Copyright 2016-present Daniel Trugman
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#ifndef BENCHMARK_SIMD_HPP
+#define BENCHMARK_SIMD_HPP
+
+#include <algorithm>
+#include <cstdint>
+#include <cstddef>
+#include <limits>
+
+// AVX2/AVX-512 variants are compiled for their targets and chosen at runtime,
+// so no special compiler flags are needed
+#if (defined __GNUC__ || defined __clang__) && defined __x86_64__
+#   define BENCHMARK_SIMD_X86
+#   include <immintrin.h>
+#endif
+
+namespace bm {
+namespace simd {
+
+enum class Isa { scalar, avx2, avx512 };
+
+inline const char* to_string(Isa isa)
+{
+    switch (isa)
+    {
+        case Isa::scalar: return "scalar";
+        case Isa::avx2:   return "avx2";
+        case Isa::avx512: return "avx512";
+    }
+    return "unknown";
+}
+
+// Sum, min and max of an array. The sum wraps around on overflow,
+// callers rule that out using min and max.
+struct Summary
+{
+    int64_t sum;
+    int64_t min;
+    int64_t max;
+};
+
+inline Summary summarize_scalar(const int64_t* values, size_t n)
+{
+    Summary summary = { 0, (std::numeric_limits<int64_t>::max)(), (std::numeric_limits<int64_t>::min)() };
+    for (size_t i = 0; i < n; ++i)
+    {
+        summary.sum = static_cast<int64_t>(static_cast<uint64_t>(summary.sum) + static_cast<uint64_t>(values[i]));
+        summary.min = (std::min)(summary.min, values[i]);
+        summary.max = (std::max)(summary.max, values[i]);
+    }
+    return summary;
+}
+
+#ifdef BENCHMARK_SIMD_X86
+
+__attribute__((target("avx2")))
+inline Summary summarize_avx2(const int64_t* values, size_t n)
+{
+    auto sum = _mm256_setzero_si256();
+    auto min = _mm256_set1_epi64x((std::numeric_limits<int64_t>::max)());
+    auto max = _mm256_set1_epi64x((std::numeric_limits<int64_t>::min)());
+
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4)
+    {
+        auto v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(values + i));
+        sum = _mm256_add_epi64(sum, v);
+        min = _mm256_blendv_epi8(min, v, _mm256_cmpgt_epi64(min, v));
+        max = _mm256_blendv_epi8(max, v, _mm256_cmpgt_epi64(v, max));
+    }
+
+    alignas(32) int64_t sums[4], mins[4], maxs[4];
+    _mm256_store_si256(reinterpret_cast<__m256i*>(sums), sum);
+    _mm256_store_si256(reinterpret_cast<__m256i*>(mins), min);
+    _mm256_store_si256(reinterpret_cast<__m256i*>(maxs), max);
+
+    auto summary = summarize_scalar(values + i, n - i);
+    for (int lane = 0; lane < 4; ++lane)
+    {
+        summary.sum = static_cast<int64_t>(static_cast<uint64_t>(summary.sum) + static_cast<uint64_t>(sums[lane]));
+        summary.min = (std::min)(summary.min, mins[lane]);
+        summary.max = (std::max)(summary.max, maxs[lane]);
+    }
+    return summary;
+}
+
+__attribute__((target("avx512f")))
+inline Summary summarize_avx512(const int64_t* values, size_t n)
+{
+    auto sum = _mm512_setzero_si512();
+    auto min = _mm512_set1_epi64((std::numeric_limits<int64_t>::max)());
+    auto max = _mm512_set1_epi64((std::numeric_limits<int64_t>::min)());
+
+    // Masked min/max, as the unmasked ones trip GCC's uninitialized warnings
+    const __mmask8 all = 0xff;
+
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8)
+    {
+        auto v = _mm512_loadu_si512(values + i);
+        sum = _mm512_add_epi64(sum, v);
+        min = _mm512_mask_min_epi64(min, all, min, v);
+        max = _mm512_mask_max_epi64(max, all, max, v);
+    }
+
+    // The tail, with masked out lanes left neutral
+    if (i < n)
+    {
+        auto mask = static_cast<__mmask8>((1u << (n - i)) - 1);
+        auto v = _mm512_maskz_loadu_epi64(mask, values + i);
+        sum = _mm512_add_epi64(sum, v);
+        min = _mm512_mask_min_epi64(min, mask, min, v);
+        max = _mm512_mask_max_epi64(max, mask, max, v);
+    }
+
+    // Likewise rather than _mm512_reduce_*
+    alignas(64) int64_t sums[8], mins[8], maxs[8];
+    _mm512_store_si512(sums, sum);
+    _mm512_store_si512(mins, min);
+    _mm512_store_si512(maxs, max);
+
+    Summary summary = { 0, (std::numeric_limits<int64_t>::max)(), (std::numeric_limits<int64_t>::min)() };
+    for (int lane = 0; lane < 8; ++lane)
+    {
+        summary.sum = static_cast<int64_t>(static_cast<uint64_t>(summary.sum) + static_cast<uint64_t>(sums[lane]));
+        summary.min = (std::min)(summary.min, mins[lane]);
+        summary.max = (std::max)(summary.max, maxs[lane]);
+    }
+    return summary;
+}
+
+#endif // BENCHMARK_SIMD_X86
+
+inline bool supported(Isa isa)
+{
+#ifdef BENCHMARK_SIMD_X86
+    __builtin_cpu_init(); // Might be called before main(), e.g. by static initializers
+    switch (isa)
+    {
+        case Isa::scalar: return true;
+        case Isa::avx2:   return __builtin_cpu_supports("avx2");
+        case Isa::avx512: return __builtin_cpu_supports("avx512f");
+    }
+    return false;
+#else
+    return isa == Isa::scalar;
+#endif // BENCHMARK_SIMD_X86
+}
+
+// The widest instruction set the CPU supports
+inline Isa best()
+{
+    static const Isa isa = supported(Isa::avx512) ? Isa::avx512 :
+                           supported(Isa::avx2)   ? Isa::avx2   : Isa::scalar;
+    return isa;
+}
+
+// The isa must be supported
+inline Summary summarize(const int64_t* values, size_t n, Isa isa)
+{
+    switch (isa)
+    {
+#ifdef BENCHMARK_SIMD_X86
+        case Isa::avx512: return summarize_avx512(values, n);
+        case Isa::avx2:   return summarize_avx2(values, n);
+#endif // BENCHMARK_SIMD_X86
+        default:          return summarize_scalar(values, n);
+    }
+}
+
+inline Summary summarize(const int64_t* values, size_t n)
+{
+    return summarize(values, n, best());
+}
+
+} // namespace simd
+} // namespace bm
+
+#endif // BENCHMARK_SIMD_HPP
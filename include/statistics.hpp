@@ -0,0 +1,285 @@
+/*
+ *  Copyright 2016-present Daniel Trugman
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#ifndef BENCHMARK_STATISTICS_HPP
+#define BENCHMARK_STATISTICS_HPP
+
+#include <algorithm>
+#include <numeric>
+#include <limits>
+#include <vector>
+#include <cmath>
+
+namespace bm {
+namespace stats {
+
+inline double mean(const std::vector<double>& samples)
+{
+    if (samples.empty()) return 0;
+    return std::accumulate(samples.begin(), samples.end(), 0.0) / samples.size();
+}
+
+// Unbiased (sample) variance
+inline double variance(const std::vector<double>& samples)
+{
+    if (samples.size() < 2) return 0;
+
+    auto m = mean(samples);
+    double sum = 0;
+    for (auto sample : samples)
+    {
+        sum += (sample - m) * (sample - m);
+    }
+    return sum / (samples.size() - 1);
+}
+
+inline double stddev(const std::vector<double>& samples)
+{
+    return std::sqrt(variance(samples));
+}
+
+// The q-quantile (0-1), interpolating linearly between the closest ranks
+inline double quantile(std::vector<double> samples, double q)
+{
+    if (samples.empty()) return 0;
+
+    std::sort(samples.begin(), samples.end());
+    auto position = (std::min)((std::max)(q, 0.0), 1.0) * (samples.size() - 1);
+    auto lower = static_cast<size_t>(position);
+    if (lower + 1 >= samples.size()) return samples.back();
+
+    return samples[lower] + (position - lower) * (samples[lower + 1] - samples[lower]);
+}
+
+inline double median(const std::vector<double>& samples)
+{
+    return quantile(samples, 0.5);
+}
+
+// Median absolute deviation from the median, unscaled
+inline double mad(const std::vector<double>& samples)
+{
+    auto center = median(samples);
+    std::vector<double> deviations;
+    deviations.reserve(samples.size());
+    for (auto sample : samples)
+    {
+        deviations.push_back(std::fabs(sample - center));
+    }
+    return median(deviations);
+}
+
+// The mean of what is left after dropping the given proportion (0-0.5)
+// of the smallest samples, and the same proportion of the largest ones
+inline double trimmed_mean(std::vector<double> samples, double proportion = 0.1)
+{
+    if (samples.empty()) return 0;
+
+    std::sort(samples.begin(), samples.end());
+    auto trim = static_cast<size_t>((std::min)((std::max)(proportion, 0.0), 0.5) * samples.size());
+    if (2 * trim >= samples.size()) return median(samples);
+
+    return std::accumulate(samples.begin() + trim, samples.end() - trim, 0.0) / (samples.size() - 2 * trim);
+}
+
+// Interquartile range
+inline double iqr(const std::vector<double>& samples)
+{
+    return quantile(samples, 0.75) - quantile(samples, 0.25);
+}
+
+// Samples outside [q1 - k * iqr, q3 + k * iqr] are outliers, k is usually 1.5
+struct Fences
+{
+    double lower;
+    double upper;
+
+    bool contain(double sample) const { return lower <= sample && sample <= upper; }
+};
+
+inline Fences tukey_fences(const std::vector<double>& samples, double k = 1.5)
+{
+    auto q1 = quantile(samples, 0.25);
+    auto q3 = quantile(samples, 0.75);
+    Fences fences = { q1 - k * (q3 - q1), q3 + k * (q3 - q1) };
+    return fences;
+}
+
+// Standard normal cumulative distribution function
+inline double normal_cdf(double x)
+{
+    return 0.5 * std::erfc(-x / std::sqrt(2.0));
+}
+
+// Inverse of normal_cdf, found by bisection
+inline double normal_quantile(double p)
+{
+    if (p <= 0) return -std::numeric_limits<double>::infinity();
+    if (p >= 1) return  std::numeric_limits<double>::infinity();
+
+    double lo = -40;
+    double hi =  40;
+    for (int i = 0; i < 200; ++i)
+    {
+        auto mid = (lo + hi) / 2;
+        if (normal_cdf(mid) < p) lo = mid; else hi = mid;
+    }
+    return (lo + hi) / 2;
+}
+
+// Continued fraction of the regularized incomplete beta function
+inline double incomplete_beta_fraction(double a, double b, double x)
+{
+    static const double tiny = 1e-300;
+
+    auto c = 1.0;
+    auto d = 1.0 - (a + b) * x / (a + 1);
+    d = 1.0 / ((std::fabs(d) < tiny) ? tiny : d);
+    auto h = d;
+
+    for (int m = 1; m <= 300; ++m)
+    {
+        auto m2 = 2.0 * m;
+
+        auto step = m * (b - m) * x / ((a + m2 - 1) * (a + m2));
+        d = 1.0 + step * d;
+        c = 1.0 + step / c;
+        d = 1.0 / ((std::fabs(d) < tiny) ? tiny : d);
+        c = (std::fabs(c) < tiny) ? tiny : c;
+        h *= d * c;
+
+        step = -(a + m) * (a + b + m) * x / ((a + m2) * (a + m2 + 1));
+        d = 1.0 + step * d;
+        c = 1.0 + step / c;
+        d = 1.0 / ((std::fabs(d) < tiny) ? tiny : d);
+        c = (std::fabs(c) < tiny) ? tiny : c;
+        auto delta = d * c;
+        h *= delta;
+
+        if (std::fabs(delta - 1.0) < 1e-15) break;
+    }
+    return h;
+}
+
+// Regularized incomplete beta function I_x(a, b)
+inline double incomplete_beta(double a, double b, double x)
+{
+    if (x <= 0) return 0;
+    if (x >= 1) return 1;
+
+    auto front = std::exp(std::lgamma(a + b) - std::lgamma(a) - std::lgamma(b) +
+                          a * std::log(x) + b * std::log(1 - x));
+
+    if (x < (a + 1) / (a + b + 2))
+    {
+        return front * incomplete_beta_fraction(a, b, x) / a;
+    }
+    return 1 - front * incomplete_beta_fraction(b, a, 1 - x) / b;
+}
+
+// Two-sided p-value of Student's t distribution
+inline double student_t_p_value(double t, double dof)
+{
+    if (!(dof > 0)) return 1;
+    return incomplete_beta(dof / 2, 0.5, dof / (dof + t * t));
+}
+
+struct Test
+{
+    Test() : statistic(0), p_value(1) {}
+
+    double statistic;
+    double p_value;   // Two-sided
+};
+
+// Welch's unequal variances t-test
+inline Test welch_test(const std::vector<double>& a, const std::vector<double>& b)
+{
+    Test result;
+    if (a.size() < 2 || b.size() < 2) return result;
+
+    auto va = variance(a) / a.size();
+    auto vb = variance(b) / b.size();
+    auto diff = mean(a) - mean(b);
+
+    if (va + vb == 0)
+    {
+        result.statistic = (diff == 0) ? 0 : std::copysign(std::numeric_limits<double>::infinity(), diff);
+        result.p_value = (diff == 0) ? 1 : 0;
+        return result;
+    }
+
+    result.statistic = diff / std::sqrt(va + vb);
+
+    auto dof = (va + vb) * (va + vb) /
+               (va * va / (a.size() - 1) + vb * vb / (b.size() - 1));
+    result.p_value = student_t_p_value(result.statistic, dof);
+    return result;
+}
+
+// Mann-Whitney U test, using the normal approximation with a tie correction.
+// The statistic is U of the first sample set.
+inline Test mann_whitney_test(const std::vector<double>& a, const std::vector<double>& b)
+{
+    Test result;
+    if (a.empty() || b.empty()) return result;
+
+    std::vector<std::pair<double, bool>> all;
+    all.reserve(a.size() + b.size());
+    for (auto sample : a) all.emplace_back(sample, true);
+    for (auto sample : b) all.emplace_back(sample, false);
+    std::sort(all.begin(), all.end());
+
+    double rank_sum = 0;
+    double ties = 0;
+    for (size_t i = 0; i < all.size(); )
+    {
+        auto j = i;
+        while (j < all.size() && all[j].first == all[i].first) ++j;
+
+        // Ranks i+1..j share their average
+        auto rank = (i + 1 + j) / 2.0;
+        for (auto k = i; k < j; ++k)
+        {
+            if (all[k].second) rank_sum += rank;
+        }
+
+        double count = static_cast<double>(j - i);
+        ties += count * count * count - count;
+        i = j;
+    }
+
+    double na = static_cast<double>(a.size());
+    double nb = static_cast<double>(b.size());
+    double n = na + nb;
+
+    result.statistic = rank_sum - na * (na + 1) / 2;
+
+    auto expected = na * nb / 2;
+    auto variance = na * nb / 12 * ((n + 1) - ties / (n * (n - 1)));
+    if (variance <= 0) return result;
+
+    // Continuity correction
+    auto diff = std::fabs(result.statistic - expected) - 0.5;
+    auto z = (std::max)(diff, 0.0) / std::sqrt(variance);
+    result.p_value = (std::min)(1.0, 2 * (1 - normal_cdf(z)));
+    return result;
+}
+
+} // namespace stats
+} // namespace bm
+
+#endif // BENCHMARK_STATISTICS_HPP
@@ -0,0 +1,72 @@
+/*
+ *  Copyright 2016-present Daniel Trugman
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#ifndef BENCHMARK_SYNC_MARK_HPP
+#define BENCHMARK_SYNC_MARK_HPP
+
+#include <chrono>
+#include <mutex>
+
+#include "mark.hpp"
+
+namespace bm {
+
+// A Mark that can be updated and read from multiple threads
+class SyncMark
+{
+public: // C'tors
+    SyncMark() = default;
+    SyncMark(const SyncMark&) = delete;
+    SyncMark& operator=(const SyncMark&) = delete;
+
+public: // Overloaded operators
+    SyncMark& operator+=(const Mark& rhs)
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _mark += rhs;
+        return *this;
+    }
+
+    template < class Rep, class Period >
+    SyncMark& operator+=(const std::chrono::duration<Rep, Period>& duration)
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _mark += duration;
+        return *this;
+    }
+
+public: // Methods
+    // A consistent copy of the aggregated values
+    Mark snapshot() const
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        return _mark;
+    }
+
+    void clear()
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _mark.clear();
+    }
+
+private: // Members
+    mutable std::mutex _mutex;
+    Mark               _mark;
+};
+
+} // namespace bm
+
+#endif // BENCHMARK_SYNC_MARK_HPP
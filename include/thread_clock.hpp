@@ -27,6 +27,11 @@
 #ifdef BENCHMARK_THREAD_CPUTIME
 
 #include <time.h>
+#include <pthread.h>
+
+#include <chrono>
+#include <cstdint>
+#include <thread>
 
 namespace bm {
 
@@ -55,6 +60,36 @@ struct thread_clock
     }
 };
 
+// The CPU time of a given thread, which may be read from any other thread,
+// e.g. by a supervisor watching its workers. Only valid while the thread runs.
+class ThreadCpuClock
+{
+public:
+    explicit ThreadCpuClock(pthread_t thread) :
+        _valid(pthread_getcpuclockid(thread, &_clock) == 0) {}
+
+    explicit ThreadCpuClock(std::thread& thread) :
+        ThreadCpuClock(thread.native_handle()) {}
+
+    bool valid() const { return _valid; }
+
+    // The CPU time the thread consumed so far, false if it cannot be read,
+    // e.g. once the thread exited
+    bool now(thread_clock::time_point& time) const
+    {
+        struct timespec ts = {};
+        if (!_valid || clock_gettime(_clock, &ts) != 0) return false;
+
+        time = thread_clock::time_point(
+            thread_clock::duration(((uint64_t)ts.tv_sec * 1000000000) + (uint64_t)ts.tv_nsec));
+        return true;
+    }
+
+private:
+    clockid_t _clock;
+    bool      _valid;
+};
+
 } // namespace
 
 #endif // BENCHMARK_THREAD_CPUTIME
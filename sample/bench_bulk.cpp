@@ -0,0 +1,96 @@
+/*
+ *  Copyright 2016-present Daniel Trugman
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include <random>
+#include <vector>
+
+#include "mark.hpp"
+#include "histogram.hpp"
+#include "simd.hpp"
+#include "registry.hpp"
+
+using namespace bm;
+
+// Aggregating a trace of durations one at a time, against add_bulk()
+// and the instruction sets it chooses from
+
+static const std::vector<int64_t>& trace()
+{
+    static std::vector<int64_t> values;
+    if (values.empty())
+    {
+        std::mt19937_64 engine(1);
+        std::lognormal_distribution<double> dist(10, 1);
+        values.resize(1 << 16);
+        for (auto& value : values) value = static_cast<int64_t>(dist(engine));
+    }
+    return values;
+}
+
+BM_REGISTER("bulk/mark/scalar", []() {
+    Mark mark;
+    for (auto value : trace()) mark += Mark::nanoseconds(value);
+    processed_items(trace().size());
+    return mark.as_nanoseconds();
+});
+
+BM_REGISTER("bulk/mark/add_bulk", []() {
+    Mark mark;
+    mark.add_bulk(trace().data(), trace().size());
+    processed_items(trace().size());
+    return mark.as_nanoseconds();
+});
+
+BM_REGISTER("bulk/histogram/scalar", []() {
+    static Histogram histogram;
+    histogram.clear();
+    for (auto value : trace()) histogram.add(value);
+    processed_items(trace().size());
+    return histogram.count();
+});
+
+BM_REGISTER("bulk/histogram/add_bulk", []() {
+    static Histogram histogram;
+    histogram.clear();
+    histogram.add_bulk(trace().data(), trace().size());
+    processed_items(trace().size());
+    return histogram.count();
+});
+
+struct Summarize
+{
+    simd::Summary operator()() const
+    {
+        processed_items(trace().size());
+        return simd::summarize(trace().data(), trace().size(), isa);
+    }
+
+    simd::Isa isa;
+};
+
+static bool register_summarize()
+{
+    for (auto isa : { simd::Isa::scalar, simd::Isa::avx2, simd::Isa::avx512 })
+    {
+        if (!simd::supported(isa)) continue;
+
+        Summarize summarize = { isa };
+        register_benchmark(std::string("bulk/summarize/") + simd::to_string(isa), summarize, BENCHMARK_CXX_FLAGS);
+    }
+    return true;
+}
+
+static const bool summarize_registered = register_summarize();
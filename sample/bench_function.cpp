@@ -16,9 +16,8 @@
 
 #include <iostream>
 #include <fstream>
-#include <chrono>
 
-#include "benchmark.hpp"
+#include "registry.hpp"
 
 using namespace bm;
 
@@ -38,11 +37,19 @@ size_t count_words(const std::string& input)
     return words;
 }
 
-int main()
+static const std::string input("./sample/lipsum.txt");
+
+static uint64_t file_size(const std::string& path)
 {
-    std::string input("./sample/lipsum.txt");
-    auto result = Bench::mark(count_words, input);
-    std::cout << result.first << std::endl;
-    std::cout << "Retval = " << result.second << std::endl;
-    return 0;
+    std::ifstream fin(path, std::ios::binary | std::ios::ate);
+    return fin ? static_cast<uint64_t>(fin.tellg()) : 0;
 }
+
+BM_REGISTER("count_words", []() {
+    static const uint64_t size = file_size(input);
+
+    auto words = count_words(input);
+    processed_bytes(size);
+    processed_items(words);
+    return words;
+});
@@ -0,0 +1,510 @@
+/*
+ *  Copyright 2016-present Daniel Trugman
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include <sys/syscall.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <fcntl.h>
+
+#ifdef BENCHMARK_IO_URING
+#   include <linux/io_uring.h>
+#endif
+
+#include <algorithm>
+#include <stdexcept>
+#include <iostream>
+#include <fstream>
+#include <iomanip>
+#include <cstring>
+#include <cstdlib>
+#include <cstdio>
+#include <string>
+#include <vector>
+#include <map>
+
+#include "benchmark.hpp"
+#include "cache.hpp"
+#include "runner.hpp"
+#include "words.hpp"
+
+using namespace bm;
+
+// Counting the words of generated files of 1MiB to 1GiB, reading them in
+// different ways, and counting mapped ones with vectorized kernels too.
+// The wall time gives the throughput, thread_clock the CPU time of the
+// counting thread itself, i.e. without io_uring's kernel workers.
+
+static const size_t chunk = 1 << 20;
+
+class File
+{
+public:
+    explicit File(const std::string& path) : _fd(open(path.c_str(), O_RDONLY))
+    {
+        if (_fd < 0)
+        {
+            throw std::runtime_error("Open input file failed!");
+        }
+    }
+
+    ~File() { close(_fd); }
+
+    File(const File&) = delete;
+    File& operator=(const File&) = delete;
+
+    int fd() const { return _fd; }
+
+    size_t size() const
+    {
+        struct stat st;
+        return (fstat(_fd, &st) == 0) ? static_cast<size_t>(st.st_size) : 0;
+    }
+
+private:
+    int _fd;
+};
+
+// As in sample/bench_function.cpp
+static size_t count_ifstream(const std::string& path, WordCounter::Kernel)
+{
+    std::ifstream fin(path, std::ios::binary);
+    if (!fin)
+    {
+        throw std::runtime_error("Open input file failed!");
+    }
+
+    size_t words;
+    std::string word;
+    for (words = 0; fin >> word; ++words)
+        ;
+
+    return words;
+}
+
+static size_t count_read(const std::string& path, WordCounter::Kernel kernel)
+{
+    static std::vector<char> buffer(chunk);
+
+    File file(path);
+    WordCounter counter(kernel);
+
+    ssize_t length;
+    while ((length = read(file.fd(), buffer.data(), buffer.size())) > 0)
+    {
+        counter.feed(buffer.data(), static_cast<size_t>(length));
+    }
+    if (length < 0)
+    {
+        throw std::runtime_error("Read failed!");
+    }
+
+    return counter.words();
+}
+
+static size_t count_mmap(const std::string& path, WordCounter::Kernel kernel)
+{
+    File file(path);
+    auto size = file.size();
+    if (size == 0) return 0;
+
+    auto data = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, file.fd(), 0);
+    if (data == MAP_FAILED)
+    {
+        throw std::runtime_error("Mapping input file failed!");
+    }
+    madvise(data, size, MADV_SEQUENTIAL);
+
+    WordCounter counter(kernel);
+    counter.feed(static_cast<const char*>(data), size);
+
+    munmap(data, size);
+    return counter.words();
+}
+
+#ifdef BENCHMARK_IO_URING
+
+// Just enough of io_uring for reading a file, without liburing
+class Uring
+{
+public:
+    explicit Uring(unsigned entries) : _fd(-1), _queued(0)
+    {
+        io_uring_params params;
+        std::memset(&params, 0, sizeof(params));
+        _fd = static_cast<int>(syscall(__NR_io_uring_setup, entries, &params));
+        if (_fd < 0)
+        {
+            throw std::runtime_error(std::string("io_uring unavailable: ") + std::strerror(errno));
+        }
+
+        _sq_size = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+        _cq_size = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+        _sqes_size = params.sq_entries * sizeof(io_uring_sqe);
+
+        auto single = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+        if (single) _sq_size = _cq_size = (std::max)(_sq_size, _cq_size);
+
+        _sq = map(_sq_size, IORING_OFF_SQ_RING);
+        _cq = single ? _sq : map(_cq_size, IORING_OFF_CQ_RING);
+        _sqes = static_cast<io_uring_sqe*>(map(_sqes_size, IORING_OFF_SQES));
+
+        auto sq = static_cast<char*>(_sq);
+        _sq_head  = reinterpret_cast<unsigned*>(sq + params.sq_off.head);
+        _sq_tail  = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+        _sq_mask  = reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+        _sq_array = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+
+        auto cq = static_cast<char*>(_cq);
+        _cq_head = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+        _cq_tail = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+        _cq_mask = reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+        _cqes    = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+    }
+
+    ~Uring()
+    {
+        munmap(_sqes, _sqes_size);
+        if (_cq != _sq) munmap(_cq, _cq_size);
+        munmap(_sq, _sq_size);
+        close(_fd);
+    }
+
+    Uring(const Uring&) = delete;
+    Uring& operator=(const Uring&) = delete;
+
+    // Queue a read, tagged for its completion. False if the queue is full.
+    bool read(int fd, char* buffer, unsigned length, uint64_t offset, uint64_t tag)
+    {
+        auto tail = *_sq_tail;
+        if (tail - __atomic_load_n(_sq_head, __ATOMIC_ACQUIRE) > *_sq_mask) return false;
+
+        auto index = tail & *_sq_mask;
+        auto& sqe = _sqes[index];
+        std::memset(&sqe, 0, sizeof(sqe));
+        sqe.opcode    = IORING_OP_READ;
+        sqe.fd        = fd;
+        sqe.off       = offset;
+        sqe.addr      = reinterpret_cast<uint64_t>(buffer);
+        sqe.len       = length;
+        sqe.user_data = tag;
+
+        _sq_array[index] = index;
+        __atomic_store_n(_sq_tail, tail + 1, __ATOMIC_RELEASE);
+        ++_queued;
+        return true;
+    }
+
+    // Submit the queued reads, freeing their queue entries
+    void submit()
+    {
+        enter(0, 0);
+    }
+
+    // Submit the queued reads, and wait for a completion
+    void wait()
+    {
+        enter(1, IORING_ENTER_GETEVENTS);
+    }
+
+    // Pop a completion, false if none is ready
+    bool complete(uint64_t& tag, int& result)
+    {
+        auto head = *_cq_head;
+        if (head == __atomic_load_n(_cq_tail, __ATOMIC_ACQUIRE)) return false;
+
+        const auto& cqe = _cqes[head & *_cq_mask];
+        tag = cqe.user_data;
+        result = cqe.res;
+        __atomic_store_n(_cq_head, head + 1, __ATOMIC_RELEASE);
+        return true;
+    }
+
+private:
+    void enter(unsigned min_complete, unsigned flags)
+    {
+        auto submitted = syscall(__NR_io_uring_enter, _fd, _queued, min_complete, flags, nullptr, 0);
+        if (submitted < 0)
+        {
+            if (errno == EINTR) return;
+            throw std::runtime_error(std::string("io_uring_enter failed: ") + std::strerror(errno));
+        }
+        _queued -= static_cast<unsigned>(submitted);
+    }
+
+    void* map(size_t size, off_t offset)
+    {
+        auto address = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, _fd, offset);
+        if (address == MAP_FAILED)
+        {
+            throw std::runtime_error("Mapping io_uring failed!");
+        }
+        return address;
+    }
+
+private:
+    int           _fd;
+    unsigned      _queued;
+    size_t        _sq_size;
+    size_t        _cq_size;
+    size_t        _sqes_size;
+    void*         _sq;
+    void*         _cq;
+    io_uring_sqe* _sqes;
+    unsigned*     _sq_head;
+    unsigned*     _sq_tail;
+    unsigned*     _sq_mask;
+    unsigned*     _sq_array;
+    unsigned*     _cq_head;
+    unsigned*     _cq_tail;
+    unsigned*     _cq_mask;
+    io_uring_cqe* _cqes;
+};
+
+// Keeps a few chunks in flight, and counts them in file order as they complete
+static size_t count_uring(const std::string& path, WordCounter::Kernel kernel)
+{
+    static const unsigned depth = 4;
+    static std::vector<char> buffers(depth * chunk);
+
+    File file(path);
+    auto size = file.size();
+
+    Uring ring(depth);
+    std::vector<int> ready(depth, -1);
+
+    uint64_t requested = 0;
+    auto request = [&](unsigned slot) {
+        auto length = static_cast<unsigned>((std::min)(static_cast<uint64_t>(chunk), size - requested));
+        // A full queue is submitted to make room, a chunk that is never
+        // requested would leave the completion loop waiting forever
+        if (!ring.read(file.fd(), &buffers[slot * chunk], length, requested, slot))
+        {
+            ring.submit();
+            if (!ring.read(file.fd(), &buffers[slot * chunk], length, requested, slot))
+            {
+                throw std::runtime_error("io_uring submission queue is full!");
+            }
+        }
+        requested += length;
+    };
+    for (unsigned slot = 0; slot < depth && requested < size; ++slot)
+    {
+        request(slot);
+    }
+
+    WordCounter counter(kernel);
+    uint64_t counted = 0;
+    unsigned turn = 0; // The slot of the next chunk in file order
+    while (counted < size)
+    {
+        ring.wait();
+
+        uint64_t tag;
+        int result;
+        while (ring.complete(tag, result))
+        {
+            if (result < 0)
+            {
+                throw std::runtime_error(std::string("io_uring read failed: ") + std::strerror(-result));
+            }
+            ready[tag] = result;
+        }
+
+        while (ready[turn] >= 0)
+        {
+            if (static_cast<uint64_t>(ready[turn]) != (std::min)(static_cast<uint64_t>(chunk), size - counted))
+            {
+                throw std::runtime_error("Short io_uring read!");
+            }
+
+            counter.feed(&buffers[turn * chunk], static_cast<size_t>(ready[turn]));
+            counted += static_cast<uint64_t>(ready[turn]);
+            ready[turn] = -1;
+
+            if (requested < size) request(turn);
+            turn = (turn + 1) % depth;
+        }
+    }
+    return counter.words();
+}
+
+#endif // BENCHMARK_IO_URING
+
+struct Variant
+{
+    const char*         name;
+    size_t            (*count)(const std::string&, WordCounter::Kernel);
+    WordCounter::Kernel kernel;
+
+    size_t operator()(const std::string& path) const
+    {
+        if (!WordCounter::supported(kernel))
+        {
+            throw std::runtime_error(std::string(WordCounter::to_string(kernel)) + " unsupported");
+        }
+        return count(path, kernel);
+    }
+};
+
+static const Variant variants[] = {
+    { "ifstream",  count_ifstream, WordCounter::Kernel::scalar },
+    { "read",      count_read,     WordCounter::Kernel::scalar },
+    { "mmap",      count_mmap,     WordCounter::Kernel::scalar },
+#ifdef BENCHMARK_IO_URING
+    { "io_uring",  count_uring,    WordCounter::Kernel::scalar },
+#endif // BENCHMARK_IO_URING
+    { "mmap/sse2", count_mmap,     WordCounter::Kernel::sse2 },
+    { "mmap/avx2", count_mmap,     WordCounter::Kernel::avx2 },
+};
+
+// Files of a requested size, repeating the words of the input.
+// Generated on first use and removed on exit.
+class Inputs
+{
+public:
+    explicit Inputs(const std::string& input) : _input(input) {}
+
+    ~Inputs()
+    {
+        for (const auto& generated : _generated)
+        {
+            std::remove(generated.second.c_str());
+        }
+    }
+
+    const std::string& bytes(uint64_t size)
+    {
+        auto it = _generated.find(size);
+        if (it != _generated.end()) return it->second;
+
+        std::ifstream fin(_input, std::ios::binary);
+        std::string text((std::istreambuf_iterator<char>(fin)), std::istreambuf_iterator<char>());
+        if (text.empty())
+        {
+            throw std::runtime_error("Open input file failed!");
+        }
+
+        std::string output = "/tmp/bench_io." + std::to_string(size) + ".txt";
+        std::ofstream fout(output, std::ios::binary);
+        for (uint64_t written = 0; written < size; written += text.size())
+        {
+            fout.write(text.data(), static_cast<std::streamsize>((std::min)(static_cast<uint64_t>(text.size()), size - written)));
+        }
+        return _generated[size] = output;
+    }
+
+private:
+    std::string                     _input;
+    std::map<uint64_t, std::string> _generated;
+};
+
+struct Flags
+{
+    Flags() : max_size(1 << 30), min_time(std::chrono::milliseconds(500)), cold(false) {}
+
+    uint64_t          max_size;
+    Mark::nanoseconds min_time;
+    bool              cold;
+};
+
+static bool parse(int argc, char* argv[], Flags& flags)
+{
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string arg(argv[i]);
+        if (arg == "--cold")
+        {
+            flags.cold = true;
+        }
+        else if (arg.compare(0, 11, "--max_size=") == 0)
+        {
+            flags.max_size = std::strtoull(arg.c_str() + 11, nullptr, 10) << 20;
+        }
+        else if (arg.compare(0, 11, "--min_time=") == 0)
+        {
+            auto seconds = std::strtod(arg.c_str() + 11, nullptr);
+            flags.min_time = Mark::nanoseconds(static_cast<int64_t>(seconds * 1e9));
+        }
+        else
+        {
+            return false;
+        }
+    }
+    return flags.max_size >= (1 << 20);
+}
+
+int main(int argc, char* argv[])
+{
+    Flags flags;
+    if (!parse(argc, argv, flags))
+    {
+        std::cerr << "Usage: " << argv[0] << " [flags]\n"
+                  << "  --max_size=<MiB>     Largest file (default: 1024)\n"
+                  << "  --min_time=<seconds> Minimal measured time per variant and size (default: 0.5)\n"
+                  << "  --cold               Drop the file from the page cache ahead of every pass\n";
+        return 2;
+    }
+
+    Inputs inputs("./sample/lipsum.txt");
+    std::cout << std::fixed << std::setprecision(2);
+
+    for (auto size : range(1 << 20, static_cast<int64_t>(flags.max_size), 8))
+    {
+        const auto& path = inputs.bytes(static_cast<uint64_t>(size));
+
+        size_t expected = 0;
+        for (const auto& variant : variants)
+        {
+            std::cout << "io/" << variant.name << "/" << (size >> 20) << "MiB: ";
+
+            Mark wall;
+            Mark cpu;
+            size_t words = 0;
+            try
+            {
+                while (wall.iterations() == 0 || wall.as_nanoseconds() < flags.min_time.count())
+                {
+                    if (flags.cold) cache::drop_page_cache(path);
+
+                    auto timed = Thread::mark([&]() { return Bench::mark(variant, path); });
+                    cpu  += timed.first;
+                    wall += timed.second.first;
+                    wall.add_bytes(static_cast<uint64_t>(size));
+                    words = timed.second.second;
+                }
+            }
+            catch (const std::exception& e)
+            {
+                std::cout << "skipped (" << e.what() << ")" << std::endl;
+                continue;
+            }
+
+            std::cout << wall.bytes_per_second() / 1e6 << "MB/s, "
+                      << cpu.average().as_nanoseconds() / 1e6 << "ms CPU per pass ("
+                      << 100.0 * cpu.as_nanoseconds() / wall.as_nanoseconds() << "% of wall), "
+                      << words << " words" << std::endl;
+
+            if (expected == 0) expected = words;
+            if (words != expected)
+            {
+                std::cerr << variant.name << " counted " << words << " words, expected " << expected << "\n";
+                return 1;
+            }
+        }
+    }
+    return 0;
+}
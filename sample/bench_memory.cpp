@@ -0,0 +1,51 @@
+/*
+ *  Copyright 2016-present Daniel Trugman
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include <iostream>
+#include <numeric>
+#include <vector>
+
+#include "benchmark.hpp"
+#include "memory_profile.hpp"
+#include "runner.hpp"
+
+using namespace bm;
+
+// The memory ceilings of this machine as a curve from L1 to memory,
+// and a Mark put into their context
+int main()
+{
+    auto profile = profile_memory();
+    std::cout << profile << std::endl;
+
+    // Summing a vector four times the size of the last level cache
+    std::vector<uint32_t> values(cache::sizes().llc, 1);
+
+    Mark mark;
+    for (int i = 0; i < 10; ++i)
+    {
+        auto timed = Bench::mark([&values]() {
+            return std::accumulate(values.begin(), values.end(), static_cast<uint64_t>(0));
+        });
+        do_not_optimize(timed.second);
+
+        mark += timed.first;
+        mark.add_bytes(values.size() * sizeof(values[0]));
+    }
+
+    std::cout << "std::accumulate: " << profile.context(mark) << std::endl;
+    return 0;
+}
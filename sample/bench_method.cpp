@@ -14,15 +14,30 @@
  *  limitations under the License.
  */
 
+#include <algorithm>
 #include <iostream>
 #include <fstream>
-#include <chrono>
+#include <cstdint>
+#include <cstddef>
+#include <memory>
+#include <new>
 #include <vector>
+#include <map>
+#include <cstdio>
 
-#include "benchmark.hpp"
+#if __cplusplus >= 201703L
+#   include <memory_resource>
+#   include <string_view>
+#endif
+
+#include "registry.hpp"
+#include "allocations.hpp"
 
 using namespace bm;
 
+// Every sample reports its allocations per iteration
+BM_COUNT_ALLOCATIONS()
+
 class Configuration
 {
 public:
@@ -46,13 +61,264 @@ private:
     std::vector<std::string> _config;
 };
 
-int main()
+// Memory handed out by bumping a pointer through blocks of growing size,
+// and only released all at once, when the arena is destroyed
+class Arena
+{
+public:
+    explicit Arena(size_t initial = 64 << 10) : _next(initial), _current(nullptr), _left(0) {}
+
+    ~Arena()
+    {
+        for (auto block : _blocks)
+        {
+            ::operator delete(block);
+        }
+    }
+
+    Arena(const Arena&) = delete;
+    Arena& operator=(const Arena&) = delete;
+
+    void* allocate(size_t bytes, size_t alignment)
+    {
+        auto padding = (alignment - reinterpret_cast<uintptr_t>(_current) % alignment) % alignment;
+        if (_current == nullptr || padding + bytes > _left)
+        {
+            grow(bytes + alignment);
+            padding = (alignment - reinterpret_cast<uintptr_t>(_current) % alignment) % alignment;
+        }
+
+        auto memory = _current + padding;
+        _current += padding + bytes;
+        _left -= padding + bytes;
+        return memory;
+    }
+
+private:
+    void grow(size_t minimal)
+    {
+        auto size = (std::max)(_next, minimal);
+        // Through operator new, so blocks are counted like the pmr upstream's
+        auto block = static_cast<char*>(::operator new(size));
+
+        _blocks.push_back(block);
+        _current = block;
+        _left = size;
+        _next = size * 2;
+    }
+
+private:
+    std::vector<char*> _blocks;
+    size_t             _next;
+    char*              _current;
+    size_t             _left;
+};
+
+template < class T >
+struct ArenaAllocator
 {
-    std::string input("./sample/lipsum.txt");
+    using value_type = T;
+
+    explicit ArenaAllocator(Arena& arena) : arena(&arena) {}
+
+    template < class U >
+    ArenaAllocator(const ArenaAllocator<U>& other) : arena(other.arena) {}
+
+    T* allocate(size_t n) { return static_cast<T*>(arena->allocate(n * sizeof(T), alignof(T))); }
+    void deallocate(T*, size_t) {}
+
+    template < class U >
+    bool operator==(const ArenaAllocator<U>& other) const { return arena == other.arena; }
+
+    template < class U >
+    bool operator!=(const ArenaAllocator<U>& other) const { return arena != other.arena; }
 
-    Configuration config;
-    auto result = Bench::mark(std::mem_fn(&Configuration::Load), &config, input);
-    std::cout << result.first << std::endl;
-    std::cout << "Success = " << result.second << std::endl;
-    return 0;
+    Arena* arena;
+};
+
+// A word within the loaded text
+#if __cplusplus >= 201703L
+using Word = std::string_view;
+#else
+struct Word
+{
+    const char* data;
+    size_t      size;
+};
+#endif
+
+// Reads the whole input into the arena with a single read, and keeps
+// the words as views of it, in a vector allocated from the arena too
+class ArenaConfiguration
+{
+public:
+    ArenaConfiguration() : _arena(new Arena()), _config(ArenaAllocator<Word>(*_arena)) {}
+
+    bool Load(const std::string& input)
+    {
+        std::ifstream fin;
+        fin.rdbuf()->pubsetbuf(nullptr, 0); // Unbuffered, as it is read at once
+        fin.open(input, std::ios::binary | std::ios::ate);
+        if (!fin)
+        {
+            return false;
+        }
+
+        auto size = static_cast<size_t>(fin.tellg());
+        auto text = static_cast<char*>(_arena->allocate(size, 1));
+        fin.seekg(0);
+        if (!fin.read(text, static_cast<std::streamsize>(size)))
+        {
+            return false;
+        }
+
+        for (size_t i = 0; i < size; )
+        {
+            while (i < size && is_space(text[i])) ++i;
+
+            auto begin = i;
+            while (i < size && !is_space(text[i])) ++i;
+
+            if (i != begin)
+            {
+                _config.push_back(Word{ text + begin, i - begin });
+            }
+        }
+        return true;
+    }
+
+private:
+    static bool is_space(char c)
+    {
+        return c == ' ' || (c >= '\t' && c <= '\r');
+    }
+
+private:
+    std::unique_ptr<Arena>                  _arena;
+    std::vector<Word, ArenaAllocator<Word>> _config;
+};
+
+#if __cplusplus >= 201703L
+
+// The original Load(), with the strings and the vector allocated from a
+// monotonic resource
+class PmrConfiguration
+{
+public:
+    PmrConfiguration() :
+        _resource(new std::pmr::monotonic_buffer_resource(64 << 10)),
+        _config(_resource.get()) {}
+
+    bool Load(const std::string& input)
+    {
+        std::ifstream fin(input, std::ios::binary);
+        if (!fin)
+        {
+            return false;
+        }
+
+        std::pmr::string word(_resource.get());
+        while (fin >> word)
+        {
+            _config.emplace_back(word);
+        }
+        return true;
+    }
+
+private:
+    std::unique_ptr<std::pmr::monotonic_buffer_resource> _resource;
+    std::pmr::vector<std::pmr::string>                   _config;
+};
+
+#endif // __cplusplus >= 201703L
+
+// Files of a requested number of words, taken from the input.
+// Generated on first use and removed on exit.
+class Inputs
+{
+public:
+    explicit Inputs(const std::string& input) : _input(input) {}
+
+    ~Inputs()
+    {
+        for (const auto& generated : _generated)
+        {
+            std::remove(generated.second.c_str());
+        }
+    }
+
+    const std::string& words(int64_t count)
+    {
+        auto it = _generated.find(count);
+        if (it != _generated.end()) return it->second;
+
+        std::ifstream fin(_input, std::ios::binary);
+        std::vector<std::string> source;
+        std::string word;
+        while (fin >> word)
+        {
+            source.push_back(word);
+        }
+
+        std::string output = "/tmp/bench_method." + std::to_string(count) + ".txt";
+        std::ofstream fout(output, std::ios::binary);
+        for (int64_t i = 0; i < count && !source.empty(); ++i)
+        {
+            fout << source[i % source.size()] << ' ';
+        }
+        return _generated[count] = output;
+    }
+
+private:
+    std::string                    _input;
+    std::map<int64_t, std::string> _generated;
+};
+
+static const std::string input("./sample/lipsum.txt");
+static Inputs inputs(input);
+
+// Repeated loads, each into a fresh configuration.
+// Only Load() itself is measured.
+template < class Config >
+static bool register_load(const std::string& name)
+{
+    return register_fixture(name,
+        []() { return Config(); },
+        [](Config& fresh) { return fresh.Load(input); },
+        [](Config&) {},
+        BENCHMARK_CXX_FLAGS);
+}
+
+// How does Load() scale with the number of words?
+static Sweep words()
+{
+    Sweep sweep;
+    sweep.args = product({ range(1 << 10, 1 << 16, 2) });
+    return sweep;
 }
+
+template < class Config >
+static bool register_load_sweep(const std::string& name)
+{
+    using State = std::pair<Config, std::string>;
+
+    return register_sweep_fixture(name + "/words", words(),
+        [](const Args& args) { return State(Config(), inputs.words(args[0])); },
+        [](State& fresh) { return fresh.first.Load(fresh.second); },
+        [](State&) {},
+        BENCHMARK_CXX_FLAGS);
+}
+
+// The original loader next to ones that avoid allocating per word
+static const bool loads_registered =
+    register_load<Configuration>("Configuration::Load") &&
+    register_load<ArenaConfiguration>("ArenaConfiguration::Load") &&
+#if __cplusplus >= 201703L
+    register_load<PmrConfiguration>("PmrConfiguration::Load") &&
+#endif
+    register_load_sweep<Configuration>("Configuration::Load") &&
+    register_load_sweep<ArenaConfiguration>("ArenaConfiguration::Load")
+#if __cplusplus >= 201703L
+    && register_load_sweep<PmrConfiguration>("PmrConfiguration::Load")
+#endif
+    ;
@@ -17,14 +17,10 @@
 #include <iostream>
 #include <fstream>
 
-#include "benchmark.hpp"
+#include "registry.hpp"
 
 using namespace bm;
 
-int main()
-{
-    std::string input("./sample/lipsum.txt");
-    auto mark = Bench::mark([input]() { std::ifstream fin(input, std::ios::binary); });
-    std::cout << mark << std::endl;
-    return 0;
-}
+static const std::string input("./sample/lipsum.txt");
+
+BM_REGISTER("open", []() { std::ifstream fin(input, std::ios::binary); });
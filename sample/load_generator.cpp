@@ -0,0 +1,154 @@
+/*
+ *  Copyright 2016-present Daniel Trugman
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include <iostream>
+#include <stdexcept>
+#include <cstdlib>
+#include <chrono>
+#include <thread>
+#include <mutex>
+
+#include "load.hpp"
+
+#if defined __linux__ || defined __APPLE__
+#   include <arpa/inet.h>
+#   include <netinet/in.h>
+#   include <netinet/tcp.h>
+#   include <sys/socket.h>
+#   include <unistd.h>
+#   define LOOPBACK_SUPPORTED
+#endif
+
+using namespace bm;
+
+// An in-process service, which stalls every now and then (e.g. a GC pause)
+class Service
+{
+public:
+    Service() : _requests(0) {}
+
+    void handle()
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (++_requests % 1000 == 0)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        }
+    }
+
+private:
+    std::mutex _mutex;
+    uint64_t   _requests;
+};
+
+#ifdef LOOPBACK_SUPPORTED
+
+// A loopback TCP echo server standing in for a remote service
+class Echo
+{
+public:
+    Echo() : _listener(-1), _server(-1), _client(-1)
+    {
+        _listener = socket(AF_INET, SOCK_STREAM, 0);
+
+        sockaddr_in address = {};
+        address.sin_family = AF_INET;
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        socklen_t length = sizeof(address);
+
+        if (_listener < 0 ||
+            bind(_listener, reinterpret_cast<sockaddr*>(&address), length) != 0 ||
+            listen(_listener, 1) != 0 ||
+            getsockname(_listener, reinterpret_cast<sockaddr*>(&address), &length) != 0)
+        {
+            throw std::runtime_error("Listening on loopback failed!");
+        }
+
+        _client = socket(AF_INET, SOCK_STREAM, 0);
+        if (_client < 0 || connect(_client, reinterpret_cast<sockaddr*>(&address), length) != 0)
+        {
+            throw std::runtime_error("Connecting to loopback failed!");
+        }
+
+        _server = accept(_listener, nullptr, nullptr);
+        if (_server < 0)
+        {
+            throw std::runtime_error("Accepting on loopback failed!");
+        }
+
+        int enable = 1;
+        setsockopt(_client, IPPROTO_TCP, TCP_NODELAY, &enable, sizeof(enable));
+        setsockopt(_server, IPPROTO_TCP, TCP_NODELAY, &enable, sizeof(enable));
+
+        _thread = std::thread([this]() {
+            char byte;
+            while (recv(_server, &byte, 1, 0) == 1 && send(_server, &byte, 1, 0) == 1)
+                ;
+        });
+    }
+
+    ~Echo()
+    {
+        shutdown(_client, SHUT_RDWR);
+        _thread.join();
+        close(_client);
+        close(_server);
+        close(_listener);
+    }
+
+    // A single round trip
+    void request()
+    {
+        char byte = 'x';
+        if (send(_client, &byte, 1, 0) != 1 || recv(_client, &byte, 1, 0) != 1)
+        {
+            throw std::runtime_error("Loopback round trip failed!");
+        }
+    }
+
+private:
+    int         _listener;
+    int         _server;
+    int         _client;
+    std::thread _thread;
+};
+
+#endif // LOOPBACK_SUPPORTED
+
+int main(int argc, char* argv[])
+{
+    LoadOptions opts;
+    opts.rate = (argc > 1) ? std::atof(argv[1]) : 5000;
+    if (!(opts.rate > 0))
+    {
+        std::cerr << "Usage: " << argv[0] << " [requests per second, positive]" << std::endl;
+        return 1;
+    }
+    opts.duration = std::chrono::seconds(2);
+    opts.arrivals = LoadOptions::Arrivals::poisson;
+
+    Service service;
+    std::cout << "In-process service at " << opts.rate << " requests per second:\n"
+              << generate_load([&service]() { service.handle(); }, opts) << std::endl;
+
+#ifdef LOOPBACK_SUPPORTED
+    Echo echo;
+    std::cout << "Loopback echo at " << opts.rate << " requests per second:\n"
+              << generate_load([&echo]() { echo.request(); }, opts) << std::endl;
+#endif // LOOPBACK_SUPPORTED
+
+    return 0;
+}
@@ -14,67 +14,156 @@
  *  limitations under the License.
  */
 
-#include <iostream>
-#include <fstream>
-#include <chrono>
-#include <vector>
+#include <memory>
 #include <random>
-#include <map>
+#include <string>
+#include <vector>
 
 #include "benchmark.hpp"
+#include "random.hpp"
+#include "simd.hpp"
+#include "registry.hpp"
 
 // NOTE:
 // Example based on https://en.cppreference.com/w/cpp/numeric/random/random_device
 
 using namespace bm;
 
+// How a random number is reduced into [from, to]
+struct Distribution
+{
+    // A fresh distribution per number, as the cppreference example does
+    template < class Engine >
+    int operator()(Engine& engine, int from, int to) const
+    {
+        std::uniform_int_distribution<int> dist(from, to);
+        return dist(engine);
+    }
+};
+
+struct Lemire
+{
+    template < class Engine >
+    int operator()(Engine& engine, int from, int to) const
+    {
+        return from + static_cast<int>(bounded(engine, static_cast<uint32_t>(to - from) + 1));
+    }
+};
+
+template < class Engine, class Range >
 class RNG
 {
 public:
     int generate(int from, int to)
     {
         Bench::Probe probe(_generate_mark);
+        probe.items(1);
+
+        return _range(_engine, from, to);
+    }
+
+    // Many numbers under a single probe, so reading the clock is amortized
+    void fill(std::vector<int>& numbers, int from, int to)
+    {
+        Bench::Probe probe(_generate_mark);
+        probe.items(numbers.size());
 
-		std::uniform_int_distribution<int> dist(from, to);
-        return dist(_rd);
+        for (auto& number : numbers) number = _range(_engine, from, to);
     }
 
-    friend std::ostream& operator<<(std::ostream& out, RNG& rng);
+    // Aggregated by the probe, for production monitoring
+    const Mark& generate_mark() const { return _generate_mark; }
 
 private:
-    Mark _generate_mark;
-    std::random_device _rd;
+    Mark   _generate_mark;
+    Engine _engine;
+    Range  _range;
 };
 
-inline std::ostream& operator<<(std::ostream& out, RNG& rng)
+// Numbers generated by every iteration of the fill benchmarks
+static const size_t fill_size = 1024;
+
+// Generators outlive the iterations, as they would in production, so batched
+// engines refill their buffers only once in a while. They are shared since
+// std::random_device can't be copied or moved.
+template < class Engine, class Range >
+bool register_rng(const std::string& variant)
 {
-    out << "Generated " << rng._generate_mark.iterations() << " numbers:\n"
-        << "Total time = " << rng._generate_mark.as_nanoseconds() << "ns\n"
-        << "Average time = " << rng._generate_mark.average().as_nanoseconds() << "ns\n"
-        << "Max time = " << rng._generate_mark.maximal().as_nanoseconds() << "ns\n"
-        << "Min time = " << rng._generate_mark.minimal().as_nanoseconds() << "ns\n";
-    return out;
+    std::shared_ptr<RNG<Engine, Range>> rng(new RNG<Engine, Range>());
+    register_benchmark("RNG::generate/" + variant, [rng]() {
+        processed_items(1);
+        return rng->generate(0, 9);
+    }, BENCHMARK_CXX_FLAGS);
+
+    std::shared_ptr<std::vector<int>> numbers(new std::vector<int>(fill_size));
+    register_benchmark("RNG::fill/" + variant, [rng, numbers]() {
+        rng->fill(*numbers, 0, 9);
+        processed_items(numbers->size());
+        return numbers->back();
+    }, BENCHMARK_CXX_FLAGS);
+    return true;
 }
 
-int main()
+// Raw 64-bit numbers into a buffer, without reducing them into a range,
+// one at a time or four lanes at a time
+struct ScalarFill
 {
-    RNG rng;
+    void operator()(uint64_t* out, size_t n)
+    {
+        for (size_t i = 0; i < n; ++i) out[i] = engine();
+    }
 
-    static const int from = 0;
-    static const int to   = 9;
+    Xoshiro256 engine;
+};
 
-    std::map<int, int> hist;
-    for (auto i = 0; i < 20000; ++i)
+struct BatchedFill
+{
+    void operator()(uint64_t* out, size_t n)
     {
-        ++hist[rng.generate(from, to)];
+        engine.fill(out, n, isa);
     }
 
-    std::cout << "Generation histogram:\n";
-    for (auto h : hist)
+    Xoshiro256x4 engine;
+    simd::Isa    isa;
+};
+
+template < class Fill >
+bool register_buffer(const std::string& variant, Fill fill)
+{
+    std::shared_ptr<Mark> mark(new Mark());
+    std::shared_ptr<std::vector<uint64_t>> numbers(new std::vector<uint64_t>(fill_size));
+    register_benchmark("RNG::buffer/" + variant, [mark, numbers, fill]() mutable {
+        Bench::Probe probe(*mark);
+        probe.items(numbers->size());
+
+        fill(numbers->data(), numbers->size());
+        processed_items(numbers->size());
+        return numbers->back();
+    }, BENCHMARK_CXX_FLAGS);
+    return true;
+}
+
+static bool register_buffers()
+{
+    register_buffer("xoshiro256", ScalarFill());
+    for (auto isa : { simd::Isa::scalar, simd::Isa::avx2 })
     {
-        std::cout << h.first << " : " << std::string(h.second / 100, '*') << '\n';
-    }
-    std::cout << "\n" << rng;
+        if (!simd::supported(isa)) continue;
 
-    return 0;
+        BatchedFill fill = { Xoshiro256x4(), isa };
+        register_buffer(std::string("xoshiro256x4/") + simd::to_string(isa), fill);
+    }
+    return true;
 }
+
+// ns per iteration of RNG::generate is the cost of a number, and items/s the
+// numbers per second. RNG::fill and RNG::buffer amortize the probe over 1024
+// numbers, and report the ns per number. Xoshiro256x4 draws from buffers
+// filled four lanes at a time, which RNG::buffer times on their own.
+static const bool rngs_registered =
+    register_rng<std::random_device, Distribution>("random_device") &&
+    register_rng<std::mt19937_64, Distribution>("mt19937_64") &&
+    register_rng<Xoshiro256, Distribution>("xoshiro256") &&
+    register_rng<Xoshiro256, Lemire>("xoshiro256/lemire") &&
+    register_rng<Xoshiro256x4, Lemire>("xoshiro256x4/lemire") &&
+    register_buffers();
@@ -0,0 +1,95 @@
+/*
+ *  Copyright 2016-present Daniel Trugman
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include <chrono>
+#include <iostream>
+#include <string>
+
+#include "benchmark.hpp"
+#include "registry.hpp"
+#include "ring.hpp"
+
+using namespace bm;
+
+// The cost of recording a sample, directly into a Mark,
+// or into a thread-local ring drained by a background aggregator
+
+static Mark mark;
+
+// Reports the samples an aggregator lost, once the benchmarks are done
+class LostReport
+{
+public:
+    LostReport(const RingAggregator& aggregator, std::string name) :
+        _aggregator(aggregator), _name(std::move(name)) {}
+
+    ~LostReport()
+    {
+        std::cout << _name << ": " << _aggregator.lost() << " samples lost" << std::endl;
+    }
+
+private:
+    const RingAggregator& _aggregator;
+    std::string           _name;
+};
+
+static RingAggregator& aggregator()
+{
+    static RingAggregator aggregator(1 << 16, Backpressure::drop);
+    static bool started = (aggregator.start(std::chrono::milliseconds(1)), true);
+    static LostReport report(aggregator, "probe_overhead/ring"); // Destroyed first
+    (void)started;
+    return aggregator;
+}
+
+static RingAggregator::Sink& sink()
+{
+    static RingAggregator::Sink sink = aggregator().channel("probe_overhead");
+    return sink;
+}
+
+// A ring that is always full, for the cost of dropping a sample
+static RingAggregator::Sink& full_sink()
+{
+    static RingAggregator aggregator(1, Backpressure::drop);
+    static RingAggregator::Sink sink = aggregator.channel("full");
+    static bool filled = (sink += std::chrono::nanoseconds(100), true);
+    (void)filled;
+    return sink;
+}
+
+// Tight pushes outrun the background drain, so the ring is also drained
+// ahead of every batch (by the untimed setup), which keeps a batch of
+// pushes from ever finding it full
+static int drained()
+{
+    aggregator().drain();
+    return 0;
+}
+
+BM_REGISTER("probe_overhead/record/mark", []() { mark += std::chrono::nanoseconds(100); });
+
+BM_REGISTER_FIXTURE("probe_overhead/record/ring", drained,
+    [](int&) { sink() += std::chrono::nanoseconds(100); },
+    [](int&) {});
+
+BM_REGISTER("probe_overhead/record/ring/dropped", []() { full_sink() += std::chrono::nanoseconds(100); });
+
+BM_REGISTER("probe_overhead/probe/mark", []() { Bench::Probe probe(mark); });
+
+BM_REGISTER_FIXTURE("probe_overhead/probe/ring", drained,
+    [](int&) { Bench::BasicProbe<RingAggregator::Sink> probe(sink()); },
+    [](int&) {});
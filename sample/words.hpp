@@ -0,0 +1,171 @@
+/*
+ *  Copyright 2016-present Daniel Trugman
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#ifndef BENCHMARK_SAMPLE_WORDS_HPP
+#define BENCHMARK_SAMPLE_WORDS_HPP
+
+#include <cstddef>
+#include <cstdint>
+
+#include "simd.hpp"
+
+// Counts whitespace separated words the way std::istream >> std::string does
+// in the "C" locale, over a text that may arrive in several chunks.
+// The vectorized kernels classify 64 bytes at a time into a bit mask of
+// whitespace, and count the words starting in it using popcount.
+class WordCounter
+{
+public:
+    enum class Kernel { scalar, sse2, avx2 };
+
+    explicit WordCounter(Kernel kernel = Kernel::scalar) : _kernel(kernel), _words(0), _in_word(false) {}
+
+    static const char* to_string(Kernel kernel)
+    {
+        switch (kernel)
+        {
+            case Kernel::scalar: return "scalar";
+            case Kernel::sse2:   return "sse2";
+            case Kernel::avx2:   return "avx2";
+        }
+        return "unknown";
+    }
+
+    static bool supported(Kernel kernel)
+    {
+        switch (kernel)
+        {
+            case Kernel::scalar: return true;
+            case Kernel::sse2:   return x86(); // SSE2 is part of x86-64
+            case Kernel::avx2:   return bm::simd::supported(bm::simd::Isa::avx2);
+        }
+        return false;
+    }
+
+    // The kernel must be supported
+    void feed(const char* data, size_t n)
+    {
+        size_t consumed = 0;
+        switch (_kernel)
+        {
+#ifdef BENCHMARK_SIMD_X86
+            case Kernel::sse2: consumed = feed_sse2(data, n); break;
+            case Kernel::avx2: consumed = feed_avx2(data, n); break;
+#endif // BENCHMARK_SIMD_X86
+            default: break;
+        }
+        feed_scalar(data + consumed, n - consumed);
+    }
+
+    size_t words() const { return _words; }
+
+    static bool is_space(char c)
+    {
+        return c == ' ' || (c >= '\t' && c <= '\r');
+    }
+
+private:
+    static bool x86()
+    {
+#ifdef BENCHMARK_SIMD_X86
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    void feed_scalar(const char* data, size_t n)
+    {
+        for (size_t i = 0; i < n; ++i)
+        {
+            auto space = is_space(data[i]);
+            _words += (!space && !_in_word);
+            _in_word = !space;
+        }
+    }
+
+    // A word starts wherever a non-space follows a space, or the previous block's end
+    void count(uint64_t spaces)
+    {
+        auto previous = (spaces << 1) | static_cast<uint64_t>(!_in_word);
+        _words += static_cast<size_t>(__builtin_popcountll(~spaces & previous));
+        _in_word = !(spaces >> 63);
+    }
+
+#ifdef BENCHMARK_SIMD_X86
+
+    // ' ', or '\t' to '\r', i.e. c - '\t' <= 4 unsigned
+    static __m128i spaces_sse2(__m128i bytes)
+    {
+        auto shifted = _mm_sub_epi8(bytes, _mm_set1_epi8('\t'));
+        auto control = _mm_cmpeq_epi8(_mm_min_epu8(shifted, _mm_set1_epi8(4)), shifted);
+        return _mm_or_si128(control, _mm_cmpeq_epi8(bytes, _mm_set1_epi8(' ')));
+    }
+
+    size_t feed_sse2(const char* data, size_t n)
+    {
+        size_t i = 0;
+        for (; i + 64 <= n; i += 64)
+        {
+            uint64_t spaces = 0;
+            for (int part = 0; part < 4; ++part)
+            {
+                auto bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i + 16 * part));
+                auto mask = static_cast<uint32_t>(_mm_movemask_epi8(spaces_sse2(bytes)));
+                spaces |= static_cast<uint64_t>(mask) << (16 * part);
+            }
+            count(spaces);
+        }
+        return i;
+    }
+
+    __attribute__((target("avx2,popcnt")))
+    size_t feed_avx2(const char* data, size_t n)
+    {
+        auto tab   = _mm256_set1_epi8('\t');
+        auto four  = _mm256_set1_epi8(4);
+        auto space = _mm256_set1_epi8(' ');
+
+        size_t i = 0;
+        for (; i + 64 <= n; i += 64)
+        {
+            uint64_t spaces = 0;
+            for (int part = 0; part < 2; ++part)
+            {
+                auto bytes = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i + 32 * part));
+                auto shifted = _mm256_sub_epi8(bytes, tab);
+                auto control = _mm256_cmpeq_epi8(_mm256_min_epu8(shifted, four), shifted);
+                auto matches = _mm256_or_si256(control, _mm256_cmpeq_epi8(bytes, space));
+                auto mask = static_cast<uint32_t>(_mm256_movemask_epi8(matches));
+                spaces |= static_cast<uint64_t>(mask) << (32 * part);
+            }
+
+            auto previous = (spaces << 1) | static_cast<uint64_t>(!_in_word);
+            _words += static_cast<size_t>(_mm_popcnt_u64(~spaces & previous));
+            _in_word = !(spaces >> 63);
+        }
+        return i;
+    }
+
+#endif // BENCHMARK_SIMD_X86
+
+private:
+    Kernel _kernel;
+    size_t _words;
+    bool   _in_word;
+};
+
+#endif // BENCHMARK_SAMPLE_WORDS_HPP
@@ -0,0 +1,383 @@
+/*
+ *  Copyright 2016-present Daniel Trugman
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+// A main() for suites of registered benchmarks, see registry.hpp
+
+#include <algorithm>
+#include <iostream>
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include <regex>
+#include <map>
+
+#include "registry.hpp"
+#include "reporter.hpp"
+#include "context.hpp"
+#include "baseline.hpp"
+
+using namespace bm;
+
+namespace {
+
+struct Flags
+{
+    Flags() : filter("."), repetitions(1), clock(ClockType::steady), format("console"), list(false),
+              cold_and_warm(false), drop_page_cache(false) {}
+
+    std::string       filter;
+    unsigned          repetitions;
+    ClockType         clock;
+    std::string       format;
+    bool              list;
+    bool              cold_and_warm;   // Run every benchmark cold, then warm
+    bool              drop_page_cache; // Also ahead of cold iterations
+    std::string       baseline_save;
+    std::string       baseline_compare;
+    Options           opts;
+    RegressionOptions regression;
+};
+
+void usage(const char* program)
+{
+    std::cerr
+        << "Usage: " << program << " [flags]\n"
+        << "  --filter=<regex>            Run benchmarks whose name matches (default: all)\n"
+        << "  --repetitions=<n>           Repeat every benchmark n times (default: 1)\n"
+        << "  --min_time=<seconds>        Minimal measured time per benchmark (default: 0.1)\n"
+        << "  --iterations=<n>            Run exactly n iterations instead\n"
+        << "  --threads=<n>               Run every benchmark on n threads concurrently\n"
+        << "  --clock=<steady|thread|process>\n"
+        << "                              Wall clock, per-thread or process-wide CPU time (default: steady)\n"
+        << "  --capture=<batches|iterations>\n"
+        << "                              Sample batches, or time every iteration on its own (default: batches)\n"
+        << "  --reject_outliers           Drop samples outside the Tukey fences before reporting\n"
+        << "  --cache=<warm|cold|both>    Keep the caches warm, evict them ahead of every iteration,\n"
+        << "                              or run both ways side by side (default: warm)\n"
+        << "  --drop_page_cache           Also drop the page cache ahead of cold iterations,\n"
+        << "                              with --cache=cold or both (requires root)\n"
+        << "  --format=<console|json|csv> Output format (default: console)\n"
+        << "  --list                      List the matching benchmarks and exit\n"
+        << "  --baseline_save=<file>      Save the results as a baseline\n"
+        << "  --baseline_compare=<file>   Compare the results against a baseline,\n"
+        << "                              exit with 1 on significant regressions\n"
+        << "                              or if nothing matched the baseline\n"
+        << "  --threshold=<ratio>         Tolerated slowdown of a baseline comparison (default: 0.05)\n";
+}
+
+// --name=value, or false if the argument is a different flag
+bool flag(const std::string& arg, const std::string& name, std::string& value)
+{
+    auto prefix = "--" + name + "=";
+    if (arg.compare(0, prefix.size(), prefix) != 0) return false;
+
+    value = arg.substr(prefix.size());
+    return true;
+}
+
+bool parse(int argc, char* argv[], Flags& flags)
+{
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string arg(argv[i]);
+        std::string value;
+
+        if (arg == "--list")
+        {
+            flags.list = true;
+        }
+        else if (arg == "--reject_outliers")
+        {
+            flags.opts.reject_outliers = true;
+        }
+        else if (arg == "--drop_page_cache")
+        {
+            flags.drop_page_cache = true;
+        }
+        else if (flag(arg, "cache", value))
+        {
+            if (value == "warm" || value == "cold")
+            {
+                flags.opts.cache = (value == "warm") ? Options::Cache::warm : Options::Cache::cold;
+                flags.cold_and_warm = false;
+            }
+            else if (value == "both")
+            {
+                flags.cold_and_warm = true;
+            }
+            else
+            {
+                std::cerr << "Unsupported cache: " << value << "\n";
+                return false;
+            }
+        }
+        else if (flag(arg, "capture", value))
+        {
+            if (value == "batches")
+            {
+                flags.opts.capture = Options::Capture::batches;
+            }
+            else if (value == "iterations")
+            {
+                flags.opts.capture = Options::Capture::iterations;
+            }
+            else
+            {
+                std::cerr << "Unsupported capture: " << value << "\n";
+                return false;
+            }
+        }
+        else if (flag(arg, "filter", value))
+        {
+            flags.filter = value;
+        }
+        else if (flag(arg, "repetitions", value))
+        {
+            flags.repetitions = static_cast<unsigned>(std::strtoul(value.c_str(), nullptr, 10));
+        }
+        else if (flag(arg, "min_time", value))
+        {
+            auto seconds = std::strtod(value.c_str(), nullptr);
+            flags.opts.min_time = Mark::nanoseconds(static_cast<int64_t>(seconds * 1e9));
+        }
+        else if (flag(arg, "iterations", value))
+        {
+            flags.opts.iterations = std::strtoull(value.c_str(), nullptr, 10);
+        }
+        else if (flag(arg, "threads", value))
+        {
+            flags.opts.threads = static_cast<unsigned>(std::strtoul(value.c_str(), nullptr, 10));
+        }
+        else if (flag(arg, "clock", value))
+        {
+            if (value == "steady")
+            {
+                flags.clock = ClockType::steady;
+            }
+#ifdef BENCHMARK_THREAD_CPUTIME
+            else if (value == "thread")
+            {
+                flags.clock = ClockType::thread;
+            }
+#endif // BENCHMARK_THREAD_CPUTIME
+#ifdef BENCHMARK_PROCESS_CPUTIME
+            else if (value == "process")
+            {
+                flags.clock = ClockType::process;
+            }
+#endif // BENCHMARK_PROCESS_CPUTIME
+            else
+            {
+                std::cerr << "Unsupported clock: " << value << "\n";
+                return false;
+            }
+        }
+        else if (flag(arg, "format", value))
+        {
+            flags.format = value;
+        }
+        else if (flag(arg, "baseline_save", value))
+        {
+            flags.baseline_save = value;
+        }
+        else if (flag(arg, "baseline_compare", value))
+        {
+            flags.baseline_compare = value;
+        }
+        else if (flag(arg, "threshold", value))
+        {
+            flags.regression.threshold = std::strtod(value.c_str(), nullptr);
+        }
+        else
+        {
+            std::cerr << "Unknown flag: " << arg << "\n";
+            return false;
+        }
+    }
+
+    if (flags.repetitions == 0 || flags.opts.threads == 0)
+    {
+        std::cerr << "Repetitions and threads must be positive\n";
+        return false;
+    }
+
+    if (flags.drop_page_cache)
+    {
+        if (flags.opts.cache != Options::Cache::cold && !flags.cold_and_warm)
+        {
+            std::cerr << "--drop_page_cache requires --cache=cold or --cache=both\n";
+            return false;
+        }
+        if (!cache::can_drop_page_cache())
+        {
+            std::cerr << "Not permitted to drop the page cache\n";
+            return false;
+        }
+        flags.opts.evict = []() {
+            cache::default_evictor()();
+            cache::drop_page_cache();
+        };
+    }
+
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    Flags flags;
+    if (!parse(argc, argv, flags))
+    {
+        usage(argv[0]);
+        return 2;
+    }
+
+    std::vector<const Benchmark*> benchmarks;
+    try
+    {
+        benchmarks = Registry::instance().matching(flags.filter);
+    }
+    catch (const std::regex_error& e)
+    {
+        std::cerr << "Invalid filter " << flags.filter << ": " << e.what() << "\n";
+        return 2;
+    }
+
+    if (flags.list)
+    {
+        for (auto benchmark : benchmarks)
+        {
+            std::cout << benchmark->name << "\n";
+        }
+        return 0;
+    }
+
+    // The flags the selected benchmarks were compiled with, which may differ
+    // between their sources and from bm_main's own
+    auto context = Context::gather(to_string(flags.clock));
+    std::vector<std::string> compiled;
+    for (auto benchmark : benchmarks)
+    {
+        if (!benchmark->flags.empty() &&
+            std::find(compiled.begin(), compiled.end(), benchmark->flags) == compiled.end())
+        {
+            compiled.push_back(benchmark->flags);
+        }
+    }
+    for (size_t i = 0; i < compiled.size(); ++i)
+    {
+        context.flags = i ? context.flags + "; " + compiled[i] : compiled[i];
+    }
+
+    auto reporter = make_reporter(flags.format, std::cout, context);
+    if (!reporter)
+    {
+        std::cerr << "Unknown format: " << flags.format << "\n";
+        usage(argv[0]);
+        return 2;
+    }
+
+    // Repetitions of the same benchmark are merged for baselines
+    std::vector<Result> results;
+    std::map<std::string, size_t> indices;
+
+    reporter->begin();
+    for (auto benchmark : benchmarks)
+    {
+        auto run = [&](const Options& opts) { return benchmark->run(opts, flags.clock); };
+
+        for (unsigned repetition = 0; repetition < flags.repetitions; ++repetition)
+        {
+            // Cold and warm results of the same benchmark are reported side by side
+            std::vector<Report> reports;
+            std::vector<const Result*> ordered;
+            if (flags.cold_and_warm)
+            {
+                auto report = cold_and_warm(flags.opts, run);
+                reports.push_back(std::move(report.cold));
+                reports.push_back(std::move(report.warm));
+
+                const auto& cold = reports[0].results;
+                const auto& warm = reports[1].results;
+                for (size_t i = 0; i < (std::max)(cold.size(), warm.size()); ++i)
+                {
+                    if (i < cold.size()) ordered.push_back(&cold[i]);
+                    if (i < warm.size()) ordered.push_back(&warm[i]);
+                }
+            }
+            else
+            {
+                reports.push_back(run(flags.opts));
+                for (const auto& result : reports[0].results)
+                {
+                    ordered.push_back(&result);
+                }
+            }
+
+            for (auto result : ordered)
+            {
+                reporter->report(*result);
+
+                auto key = id(*result);
+                auto it = indices.find(key);
+                if (it == indices.end())
+                {
+                    indices[key] = results.size();
+                    results.push_back(*result);
+                }
+                else
+                {
+                    merge(results[it->second], *result);
+                }
+            }
+            for (const auto& report : reports)
+            {
+                reporter->summarize(report);
+            }
+        }
+    }
+    reporter->end();
+
+    if (!flags.baseline_save.empty() && !save_baseline(flags.baseline_save, results))
+    {
+        std::cerr << "Saving baseline to " << flags.baseline_save << " failed!\n";
+        return 2;
+    }
+
+    if (!flags.baseline_compare.empty())
+    {
+        std::vector<Result> baseline;
+        if (!load_baseline(flags.baseline_compare, baseline))
+        {
+            std::cerr << "Loading baseline from " << flags.baseline_compare << " failed!\n";
+            return 2;
+        }
+
+        auto regressions = detect_regressions(baseline, results, flags.regression);
+        for (const auto& regression : regressions)
+        {
+            std::cerr << regression << "\n";
+        }
+        if (compared(regressions) == 0)
+        {
+            std::cerr << "No results matched the baseline " << flags.baseline_compare << "!\n";
+        }
+        return exit_code(regressions);
+    }
+
+    return 0;
+}
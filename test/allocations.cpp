@@ -0,0 +1,78 @@
+/*
+ *  Copyright 2016-present Daniel Trugman
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+
+#include "catch.hpp"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#if __cplusplus >= 201703L
+#   include <memory_resource>
+#endif
+
+#include "runner.hpp"
+#include "allocations.hpp"
+
+using namespace std;
+using namespace bm;
+
+// For the whole test program, see "Allocation counting" in runner.cpp as well.
+// This file is built as C++17 where <memory_resource> is available, so the
+// over-aligned overloads are replaced too.
+BM_COUNT_ALLOCATIONS()
+
+#if __cplusplus >= 201703L
+
+TEST_CASE("Over-aligned allocation counting", "[runner]")
+{
+    Options opts;
+    opts.iterations = 100;
+
+    SECTION("Aligned new")
+    {
+        struct alignas(64) Line { char bytes[64]; };
+
+        auto result = Runner::run("aligned", []() {
+            unique_ptr<Line> line(new Line());
+            do_not_optimize(line.get());
+            return reinterpret_cast<uintptr_t>(line.get()) % 64;
+        }, opts);
+
+        REQUIRE(result.allocations == 100);
+    }
+
+    SECTION("Blocks of a pmr upstream")
+    {
+        // A monotonic resource takes its blocks from new_delete_resource(),
+        // which allocates them aligned
+        auto result = Runner::run("pmr", []() {
+            std::pmr::monotonic_buffer_resource resource(1024);
+            std::pmr::vector<std::pmr::string> words(&resource);
+            for (int i = 0; i < 1000; ++i)
+            {
+                words.emplace_back("a word longer than the small string buffer");
+            }
+            do_not_optimize(words.data());
+            return words.size();
+        }, opts);
+
+        REQUIRE(result.allocations >= 100 * 5);
+    }
+}
+
+#endif // __cplusplus >= 201703L
@@ -0,0 +1,169 @@
+/*
+ *  Copyright 2016-present Daniel Trugman
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include "catch.hpp"
+
+#include <sstream>
+#include <vector>
+
+#include "baseline.hpp"
+
+using namespace std;
+using namespace bm;
+
+static Result synthetic(const std::string& name, double ns, size_t batches, Args args = Args())
+{
+    Result result;
+    result.name = name;
+    result.args = args;
+    for (size_t i = 0; i < batches; ++i)
+    {
+        // Deterministic jitter of up to 1%
+        auto jitter = 1.0 + 0.01 * ((i * 7) % 11) / 10;
+        record(result, std::chrono::nanoseconds(static_cast<int64_t>(ns * jitter * 100)), 100);
+    }
+    return result;
+}
+
+TEST_CASE("Json parsing", "[json]")
+{
+    Json value;
+    REQUIRE(Json::parse("{ \"a\": [1, 2.5, -3e2], \"b\": \"x\\\"y\\n\", \"c\": true, \"d\": null }", value));
+    REQUIRE(value.type() == Json::Type::object);
+    REQUIRE(value["a"].as_array().size() == 3);
+    REQUIRE(value["a"].as_array()[1].as_number() == 2.5);
+    REQUIRE(value["a"].as_array()[2].as_number() == -300);
+    REQUIRE(value["b"].as_string() == "x\"y\n");
+    REQUIRE(value["c"].as_boolean());
+    REQUIRE(value["d"].type() == Json::Type::null);
+    REQUIRE(value["missing"].type() == Json::Type::null);
+
+    REQUIRE(Json::parse(Json::escape("tab\there \"quoted\""), value));
+    REQUIRE(value.as_string() == "tab\there \"quoted\"");
+
+    REQUIRE_FALSE(Json::parse("{ \"a\": [1, 2 }", value));
+    REQUIRE_FALSE(Json::parse("[1] trailing", value));
+    REQUIRE_FALSE(Json::parse("", value));
+}
+
+TEST_CASE("Baseline round trip", "[baseline]")
+{
+    std::vector<Result> results = {
+        synthetic("sort", 250, 20, Args({ 1024, 8 })),
+        synthetic("parse \"quoted\"", 12345, 5),
+    };
+    results.back().threads = 4;
+    results.back().mark.add_bytes(1 << 20).add_items(42);
+
+    std::stringstream stream;
+    write_baseline(stream, results);
+
+    std::vector<Result> loaded;
+    REQUIRE(read_baseline(stream, loaded));
+    REQUIRE(loaded.size() == results.size());
+
+    for (size_t i = 0; i < results.size(); ++i)
+    {
+        REQUIRE(id(loaded[i]) == id(results[i]));
+        REQUIRE(loaded[i].batches == results[i].batches);
+        REQUIRE(loaded[i].mark.iterations() == results[i].mark.iterations());
+        REQUIRE(loaded[i].mark.as_nanoseconds() == results[i].mark.as_nanoseconds());
+        REQUIRE(loaded[i].mark.minimal().as_nanoseconds() == results[i].mark.minimal().as_nanoseconds());
+        REQUIRE(loaded[i].mark.maximal().as_nanoseconds() == results[i].mark.maximal().as_nanoseconds());
+        REQUIRE(loaded[i].mark.bytes() == results[i].mark.bytes());
+        REQUIRE(loaded[i].mark.items() == results[i].mark.items());
+        REQUIRE(loaded[i].histogram.count() == results[i].histogram.count());
+        REQUIRE(loaded[i].histogram.percentile(50) == Approx(results[i].histogram.percentile(50)).epsilon(0.04));
+        REQUIRE(loaded[i].samples == results[i].samples);
+    }
+
+    SECTION("Malformed baselines")
+    {
+        std::stringstream garbage("{ \"version\": 1, \"results\": ");
+        REQUIRE_FALSE(read_baseline(garbage, loaded));
+
+        std::stringstream future("{ \"version\": 999, \"results\": [] }");
+        REQUIRE_FALSE(read_baseline(future, loaded));
+    }
+}
+
+TEST_CASE("Regression detection", "[baseline]")
+{
+    std::vector<Result> baseline = {
+        synthetic("same", 1000, 20),
+        synthetic("slower", 1000, 20),
+        synthetic("faster", 1000, 20),
+        synthetic("slightly slower", 1000, 20),
+        synthetic("removed", 1000, 20),
+    };
+
+    std::vector<Result> current = {
+        synthetic("same", 1000, 20),
+        synthetic("slower", 1200, 20),
+        synthetic("faster", 800, 20),
+        synthetic("slightly slower", 1030, 20),
+        synthetic("new", 1000, 20),
+    };
+
+    auto regressions = detect_regressions(baseline, current);
+    REQUIRE(regressions.size() == 6);
+    REQUIRE(regressions[0].verdict == Regression::Verdict::unchanged);
+    REQUIRE(regressions[1].verdict == Regression::Verdict::regressed);
+    REQUIRE(regressions[1].change == Approx(0.2).epsilon(0.01));
+    REQUIRE(regressions[2].verdict == Regression::Verdict::improved);
+    REQUIRE(regressions[3].verdict == Regression::Verdict::unchanged); // Below threshold
+    REQUIRE(regressions[4].verdict == Regression::Verdict::added);
+    REQUIRE(regressions[5].verdict == Regression::Verdict::missing);
+    REQUIRE(regressions[5].id == "removed");
+    REQUIRE(regressions[5].baseline == Approx(1000).epsilon(0.01));
+    REQUIRE(compared(regressions) == 4);
+    REQUIRE(exit_code(regressions) != 0);
+
+    SECTION("Higher threshold")
+    {
+        RegressionOptions opts;
+        opts.threshold = 0.25;
+        REQUIRE(exit_code(detect_regressions(baseline, current, opts)) == 0);
+    }
+
+    SECTION("Nothing compared")
+    {
+        // Missing and added results alone pass, as long as something matched
+        std::vector<Result> renamed = { synthetic("renamed", 1000, 20) };
+        auto result = detect_regressions(baseline, renamed);
+        REQUIRE(result.size() == 6);
+        REQUIRE(compared(result) == 0);
+        REQUIRE(exit_code(result) != 0);
+
+        std::vector<Result> filtered = { synthetic("same", 1000, 20) };
+        REQUIRE(exit_code(detect_regressions(baseline, filtered)) == 0);
+        REQUIRE(exit_code(detect_regressions(std::vector<Result>(), current)) != 0);
+    }
+
+    SECTION("Insignificant change")
+    {
+        // A single noisy batch can't be told apart from the baseline
+        std::vector<Result> noisy = { synthetic("same", 1000, 20) };
+        noisy.front().samples = { 900, 1300 };
+        std::vector<Result> before = { synthetic("same", 1000, 20) };
+        before.front().samples = { 950, 1000 };
+        noisy.front().mark.add_batch(std::chrono::microseconds(500), 100);
+
+        auto result = detect_regressions(before, noisy);
+        REQUIRE(result.front().change > 0.05);
+        REQUIRE(result.front().verdict == Regression::Verdict::unchanged);
+    }
+}
@@ -0,0 +1,150 @@
+/*
+ *  Copyright 2016-present Daniel Trugman
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include "catch.hpp"
+
+#include <cstdio>
+#include <numeric>
+#include <vector>
+
+#include "cache.hpp"
+#include "runner.hpp"
+
+using namespace std;
+using namespace bm;
+
+TEST_CASE("Cache control", "[cache]")
+{
+    SECTION("Geometry")
+    {
+        auto sizes = cache::sizes();
+        REQUIRE(sizes.line >= 16);
+        REQUIRE((sizes.line & (sizes.line - 1)) == 0);
+        REQUIRE(sizes.l1 > 0);
+        REQUIRE(sizes.llc >= sizes.l2);
+    }
+
+    SECTION("Evictor")
+    {
+        cache::Evictor evictor(1 << 20);
+        REQUIRE(evictor.size() == (1 << 20));
+        evictor();
+    }
+
+#ifdef BENCHMARK_CLFLUSH
+    SECTION("Flushing keeps the data")
+    {
+        vector<int> values(1000, 7);
+        REQUIRE(cache::flush(values));
+        REQUIRE(cache::flush(values.data() + 1, 1));
+        REQUIRE(accumulate(values.begin(), values.end(), 0) == 7000);
+    }
+#endif // BENCHMARK_CLFLUSH
+
+#if defined __linux__
+    SECTION("Dropping the pages of a file")
+    {
+        const char* path = "cache_test.tmp";
+        auto file = fopen(path, "wb");
+        REQUIRE(file != nullptr);
+        fputs("cached", file);
+        fclose(file);
+
+        REQUIRE(cache::drop_page_cache(path));
+        REQUIRE_FALSE(cache::drop_page_cache("/nonexistent/file"));
+        remove(path);
+    }
+
+    SECTION("Permission to drop the page cache")
+    {
+        // Only checked where it is not permitted, as dropping it is system wide
+        if (!cache::can_drop_page_cache())
+        {
+            REQUIRE_FALSE(cache::drop_page_cache());
+        }
+    }
+#endif // __linux__
+}
+
+TEST_CASE("Cold running", "[cache][runner]")
+{
+    Options opts;
+    opts.cache = Options::Cache::cold;
+
+    size_t evictions = 0;
+    opts.evict = [&evictions]() { ++evictions; };
+
+    SECTION("Every iteration is evicted and timed on its own")
+    {
+        auto result = Runner::run("count", []() { return 1; }, opts);
+
+        REQUIRE(result.batches == opts.cold_iterations);
+        REQUIRE(static_cast<uint64_t>(result.mark.iterations()) == opts.cold_iterations);
+        REQUIRE(evictions == opts.cold_iterations);
+    }
+
+    SECTION("Explicit iterations")
+    {
+        opts.iterations = 20;
+        Runner::fixture("vector", []() { return vector<int>(10); },
+                        [](vector<int>& v) { v.push_back(1); },
+                        [](vector<int>&) {}, opts);
+
+        REQUIRE(evictions == 20);
+    }
+
+    SECTION("Warm runs don't evict")
+    {
+        opts.cache = Options::Cache::warm;
+        opts.iterations = 100;
+        Runner::run("count", []() { return 1; }, opts);
+
+        REQUIRE(evictions == 0);
+    }
+}
+
+#ifdef BENCHMARK_CLFLUSH
+TEST_CASE("Cold and warm side by side", "[cache][runner]")
+{
+    vector<int64_t> values(1 << 18, 1);
+
+    Options opts;
+    opts.iterations = 50;
+    opts.evict = [&values]() { cache::flush(values); };
+
+    // One value per cache line, a page apart, so the prefetchers can't hide the misses
+    auto report = Runner::cold_warm("sum", [&values]() {
+        int64_t sum = 0;
+        for (size_t line = 0; line < 512; line += 8)
+        {
+            for (size_t page = line; page < values.size(); page += 512)
+            {
+                sum += values[page];
+            }
+        }
+        return sum;
+    }, opts);
+
+    REQUIRE(report.cold.results.size() == 1);
+    REQUIRE(report.warm.results.size() == 1);
+    REQUIRE(report.cold.results.front().name == "sum/cold");
+    REQUIRE(report.warm.results.front().name == "sum/warm");
+
+    auto cold = report.cold.results.front().mark.average().as_nanoseconds();
+    auto warm = report.warm.results.front().mark.average().as_nanoseconds();
+    REQUIRE(cold > warm);
+}
+#endif // BENCHMARK_CLFLUSH
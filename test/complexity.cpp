@@ -0,0 +1,79 @@
+/*
+ *  Copyright 2016-present Daniel Trugman
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include "catch.hpp"
+
+#include <vector>
+#include <cmath>
+
+#include "complexity.hpp"
+
+using namespace std;
+using namespace bm;
+
+static std::vector<std::pair<double, double>> generate(Complexity complexity, double coefficient)
+{
+    std::vector<std::pair<double, double>> samples;
+    for (double n = 1 << 10; n <= 1 << 20; n *= 2)
+    {
+        // Up to 2% of deterministic noise
+        auto noise = 1.0 + 0.02 * std::sin(n);
+        samples.emplace_back(n, coefficient * evaluate(complexity, n) * noise);
+    }
+    return samples;
+}
+
+TEST_CASE("Complexity fitting", "[complexity]")
+{
+    static const Complexity all[] = {
+        Complexity::constant,
+        Complexity::logarithmic,
+        Complexity::linear,
+        Complexity::linearithmic,
+        Complexity::quadratic,
+    };
+
+    for (auto complexity : all)
+    {
+        auto result = fit(generate(complexity, 3.5));
+        REQUIRE(result.complexity == complexity);
+        REQUIRE(result.coefficient == Approx(3.5).epsilon(0.05));
+        REQUIRE(result.rms < 0.05);
+    }
+}
+
+TEST_CASE("Complexity fitting of a specific complexity", "[complexity]")
+{
+    auto samples = generate(Complexity::linear, 2);
+
+    auto linear = fit(samples, Complexity::linear);
+    auto quadratic = fit(samples, Complexity::quadratic);
+    REQUIRE(linear.rms < quadratic.rms);
+
+    SECTION("Exact samples have no error")
+    {
+        std::vector<std::pair<double, double>> exact = { {1, 5}, {2, 10}, {4, 20} };
+        auto result = fit(exact, Complexity::linear);
+        REQUIRE(result.coefficient == Approx(5));
+        REQUIRE(result.rms < 1e-12);
+    }
+
+    SECTION("No samples")
+    {
+        auto result = fit(std::vector<std::pair<double, double>>());
+        REQUIRE(result.coefficient == 0);
+    }
+}
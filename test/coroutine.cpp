@@ -0,0 +1,139 @@
+/*
+ *  Copyright 2016-present Daniel Trugman
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include "catch.hpp"
+
+#include "coroutine.hpp"
+
+#ifdef BENCHMARK_COROUTINES
+
+#include <coroutine>
+#include <exception>
+#include <chrono>
+#include <thread>
+
+using namespace std;
+using namespace bm;
+
+namespace {
+
+// A coroutine that runs eagerly and is never awaited
+struct Detached
+{
+    struct promise_type
+    {
+        Detached get_return_object() { return {}; }
+        suspend_never initial_suspend() { return {}; }
+        suspend_never final_suspend() noexcept { return {}; }
+        void return_void() {}
+        void unhandled_exception() { std::terminate(); }
+    };
+};
+
+// Suspends until resumed by the test, and yields a value
+struct Trigger
+{
+    bool await_ready() { return false; }
+    void await_suspend(coroutine_handle<> handle) { waiting = handle; }
+    int await_resume() { return 42; }
+
+    coroutine_handle<> waiting;
+};
+
+// Decides not to suspend from within await_suspend
+struct Declined
+{
+    bool await_ready() { return false; }
+    bool await_suspend(coroutine_handle<>) { return false; }
+    void await_resume() {}
+};
+
+void spin(chrono::milliseconds duration)
+{
+    auto until = chrono::steady_clock::now() + duration;
+    while (chrono::steady_clock::now() < until) {}
+}
+
+Detached work(Mark& active, Mark& total, Trigger& trigger, chrono::milliseconds busy, int& value)
+{
+    CoroutineProbe probe(active, total);
+    spin(busy);
+    value = co_await probe(trigger);
+    spin(busy);
+}
+
+Detached declined(Mark& active, Mark& total, chrono::milliseconds busy)
+{
+    CoroutineProbe probe(active, total);
+    co_await probe(Declined());
+    spin(busy);
+    co_await probe(suspend_never());
+}
+
+} // namespace
+
+TEST_CASE("Coroutine probe excludes suspended time", "[coroutine]")
+{
+    Mark active, total;
+    Trigger trigger;
+    chrono::milliseconds busy(10), suspended(50);
+    int value = 0;
+
+    work(active, total, trigger, busy, value);
+    REQUIRE(total.iterations() == 0);
+
+    this_thread::sleep_for(suspended);
+    trigger.waiting.resume();
+
+    REQUIRE(value == 42);
+    REQUIRE(active.iterations() == 1);
+    REQUIRE(total.iterations() == 1);
+    REQUIRE(active.as_milliseconds() >= 2 * busy.count());
+    REQUIRE(active.as_milliseconds() <  suspended.count());
+    REQUIRE(total.as_milliseconds()  >= suspended.count() + 2 * busy.count());
+}
+
+TEST_CASE("Coroutine probe without suspension", "[coroutine]")
+{
+    Mark active, total;
+    chrono::milliseconds busy(10);
+
+    declined(active, total, busy);
+
+    REQUIRE(active.as_milliseconds() >= busy.count());
+    REQUIRE(total.as_milliseconds() - active.as_milliseconds() < busy.count());
+}
+
+TEST_CASE("Coroutine probe resumed on another thread", "[coroutine]")
+{
+    Mark active, total;
+    Trigger trigger;
+    chrono::milliseconds busy(5), suspended(30);
+    int value = 0;
+
+    work(active, total, trigger, busy, value);
+    thread resumer([&]() {
+        this_thread::sleep_for(suspended);
+        trigger.waiting.resume();
+    });
+    resumer.join();
+
+    REQUIRE(value == 42);
+    REQUIRE(active.as_milliseconds() <  suspended.count());
+    REQUIRE(total.as_milliseconds()  >= suspended.count());
+}
+
+#endif // BENCHMARK_COROUTINES
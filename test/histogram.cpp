@@ -0,0 +1,131 @@
+/*
+ *  Copyright 2016-present Daniel Trugman
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include "catch.hpp"
+
+#include <chrono>
+#include <random>
+#include <vector>
+
+#include "histogram.hpp"
+
+using namespace std;
+using namespace bm;
+
+TEST_CASE("Histogram buckets", "[histogram]")
+{
+    SECTION("Small values are exact")
+    {
+        for (int64_t ns = 0; ns < 64; ++ns)
+        {
+            REQUIRE(Histogram::index_of(ns) == static_cast<size_t>(ns));
+            REQUIRE(Histogram::midpoint(Histogram::index_of(ns)) == ns);
+        }
+    }
+
+    SECTION("Bucket bounds are consistent")
+    {
+        for (size_t index = 0; index + 1 < Histogram::buckets; ++index)
+        {
+            auto lower = Histogram::lower_bound(index);
+            auto upper = Histogram::lower_bound(index + 1);
+            REQUIRE(lower < upper);
+            REQUIRE(Histogram::index_of(lower) == index);
+            REQUIRE(Histogram::index_of(upper - 1) == index);
+        }
+
+        REQUIRE(Histogram::index_of(std::numeric_limits<int64_t>::max()) == Histogram::buckets - 1);
+    }
+
+    SECTION("Relative error")
+    {
+        for (int64_t ns = 64; ns < (static_cast<int64_t>(1) << 40); ns = ns * 3 + 1)
+        {
+            auto midpoint = Histogram::midpoint(Histogram::index_of(ns));
+            REQUIRE(std::abs(midpoint - ns) <= ns / 32);
+        }
+    }
+}
+
+TEST_CASE("Histogram statistics", "[histogram]")
+{
+    Histogram histogram;
+
+    SECTION("Empty")
+    {
+        REQUIRE(histogram.count() == 0);
+        REQUIRE(histogram.mean() == 0);
+        REQUIRE(histogram.percentile(50) == 0);
+    }
+
+    SECTION("Uniform values")
+    {
+        for (int64_t ns = 1; ns <= 10000; ++ns)
+        {
+            histogram += std::chrono::nanoseconds(ns);
+        }
+
+        REQUIRE(histogram.count() == 10000);
+        REQUIRE(histogram.minimal() == 1);
+        REQUIRE(histogram.maximal() == 10000);
+        REQUIRE(histogram.mean() == Approx(5000.5));
+        REQUIRE(histogram.stddev() == Approx(2886.9).epsilon(0.001));
+        REQUIRE(histogram.percentile(50) == Approx(5000).epsilon(0.04));
+        REQUIRE(histogram.percentile(99) == Approx(9900).epsilon(0.04));
+        REQUIRE(histogram.percentile(100) == 10000);
+        REQUIRE(histogram.percentile(0) == 1);
+    }
+
+    SECTION("Weighted values and merging")
+    {
+        histogram.add(100, 99);
+        Histogram other;
+        other.add(1000000, 1);
+        histogram += other;
+
+        REQUIRE(histogram.count() == 100);
+        REQUIRE(histogram.percentile(99) == Approx(100).epsilon(0.04));
+        REQUIRE(histogram.percentile(99.5) == Approx(1000000).epsilon(0.04));
+        REQUIRE(histogram.maximal() == 1000000);
+
+        histogram.clear();
+        REQUIRE(histogram.count() == 0);
+    }
+}
+
+TEST_CASE("Histogram bulk aggregation", "[histogram][simd]")
+{
+    mt19937_64 engine(7);
+    lognormal_distribution<double> dist(8, 2);
+
+    vector<int64_t> values(20000);
+    for (auto& value : values) value = static_cast<int64_t>(dist(engine));
+    values[100] = -5; // Clamped to zero, like add() does
+
+    Histogram scalar, bulk;
+    for (auto value : values) scalar.add(value);
+    bulk.add_bulk(values.data(), values.size());
+
+    REQUIRE(bulk.count() == scalar.count());
+    REQUIRE(bulk.minimal() == scalar.minimal());
+    REQUIRE(bulk.maximal() == scalar.maximal());
+    REQUIRE(bulk.mean() == Approx(scalar.mean()));
+    REQUIRE(bulk.stddev() == Approx(scalar.stddev()));
+    for (size_t i = 0; i < Histogram::buckets; ++i)
+    {
+        REQUIRE(bulk.bucket(i) == scalar.bucket(i));
+    }
+}
@@ -0,0 +1,122 @@
+/*
+ *  Copyright 2016-present Daniel Trugman
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include "catch.hpp"
+
+#include <chrono>
+#include <thread>
+#include <atomic>
+#include <limits>
+#include <cmath>
+
+#include "load.hpp"
+
+using namespace std;
+using namespace bm;
+
+TEST_CASE("Coordinated omission correction", "[histogram]")
+{
+    Histogram histogram;
+    histogram.add_corrected(100, 30);
+    REQUIRE(histogram.count() == 3);
+    REQUIRE(histogram.minimal() == 40);
+    REQUIRE(histogram.maximal() == 100);
+
+    histogram.add_corrected(20, 30);
+    REQUIRE(histogram.count() == 4);
+
+    histogram.add_corrected(1000, 0);
+    REQUIRE(histogram.count() == 5);
+}
+
+TEST_CASE("Constant load", "[load]")
+{
+    LoadOptions opts;
+    opts.rate = 2000;
+    opts.duration = std::chrono::milliseconds(100);
+
+    SECTION("Single thread")
+    {
+        auto result = generate_load([]() {}, opts);
+        REQUIRE(result.requests == 200);
+        REQUIRE(result.latency.iterations() == 200);
+        REQUIRE(result.service_histogram.count() == 200);
+        REQUIRE(result.achieved_rate() == Approx(2000).epsilon(0.2));
+    }
+
+    SECTION("Multiple threads")
+    {
+        opts.threads = 2;
+        std::atomic<int> calls(0);
+        auto result = generate_load([&calls]() { ++calls; }, opts);
+        REQUIRE(result.requests == 200);
+        REQUIRE(calls == 200);
+    }
+}
+
+TEST_CASE("Invalid load", "[load]")
+{
+    LoadOptions opts;
+    opts.duration = std::chrono::milliseconds(10);
+
+    for (double rate : { 0.0, -1.0, std::nan(""), std::numeric_limits<double>::infinity() })
+    {
+        opts.rate = rate;
+        int calls = 0;
+        auto result = generate_load([&calls]() { ++calls; }, opts);
+        REQUIRE(result.requests == 0);
+        REQUIRE(calls == 0);
+    }
+}
+
+TEST_CASE("Poisson load", "[load]")
+{
+    LoadOptions opts;
+    opts.rate = 2000;
+    opts.duration = std::chrono::milliseconds(200);
+    opts.arrivals = LoadOptions::Arrivals::poisson;
+    opts.seed = 7;
+
+    auto result = generate_load([]() {}, opts);
+    REQUIRE(result.requests > 300);
+    REQUIRE(result.requests < 500);
+}
+
+TEST_CASE("Stalled load", "[load]")
+{
+    LoadOptions opts;
+    opts.rate = 1000;
+    opts.duration = std::chrono::milliseconds(100);
+
+    std::chrono::milliseconds stall(30);
+    int calls = 0;
+    auto result = generate_load([&]() {
+        if (++calls == 10) std::this_thread::sleep_for(stall);
+    }, opts);
+
+    REQUIRE(result.requests == 100);
+
+    // A closed loop would have seen a single slow call
+    REQUIRE(result.service_histogram.percentile(90) < 1000000);
+
+    // While the requests issued during the stall waited behind it
+    REQUIRE(result.latency_histogram.maximal() >= 30000000);
+    REQUIRE(result.latency_histogram.percentile(90) > 1000000);
+
+    // Which the correction accounts for, ~30 requests that were never issued on time
+    REQUIRE(result.corrected_histogram.count() >= result.service_histogram.count() + 25);
+    REQUIRE(result.corrected_histogram.percentile(90) > 1000000);
+}
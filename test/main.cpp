@@ -21,6 +21,10 @@
 #include <chrono>
 #include <thread>
 #include <random>
+#include <future>
+#include <sstream>
+#include <cstring>
+#include <vector>
 
 #include "benchmark.hpp"
 
@@ -132,6 +136,124 @@ TEST_CASE("Mark min", "[mark]")
     }
 }
 
+TEST_CASE("Mark formatting", "[mark]")
+{
+    Mark mark;
+    char buf[128];
+
+    SECTION("Empty")
+    {
+        auto length = mark.format_to(buf, sizeof(buf));
+        REQUIRE(length == strlen(buf));
+        REQUIRE(std::string(buf) == "total 0ns, 0 iterations");
+    }
+
+    SECTION("Auto scaled units")
+    {
+        mark += std::chrono::nanoseconds(999);
+        mark += std::chrono::microseconds(1500);
+        mark += std::chrono::nanoseconds(2345678);
+        mark += std::chrono::nanoseconds(999999999);
+
+        mark.format_to(buf, sizeof(buf));
+        REQUIRE(std::string(buf) == "total 1.00s, 4 iterations, min/avg/max 999ns/250.96ms/1.00s");
+    }
+
+    SECTION("Rounding")
+    {
+        mark += std::chrono::nanoseconds(1004);
+        mark += std::chrono::nanoseconds(1996);
+        mark += std::chrono::nanoseconds(999996);
+
+        mark.format_to(buf, sizeof(buf));
+        REQUIRE(std::string(buf) == "total 1.00ms, 3 iterations, min/avg/max 1.00us/334.33us/1.00ms");
+    }
+
+    SECTION("Large values")
+    {
+        mark += std::chrono::nanoseconds::max();
+
+        mark.format_to(buf, sizeof(buf));
+        REQUIRE(std::string(buf) ==
+                "total 9223372036.85s, 1 iterations, min/avg/max 9223372036.85s/9223372036.85s/9223372036.85s");
+    }
+
+    SECTION("Truncation")
+    {
+        mark += std::chrono::milliseconds(5);
+
+        auto length = mark.format_to(buf, 10);
+        REQUIRE(length == mark.to_string().size());
+        REQUIRE(std::string(buf) == "total 5.0");
+
+        REQUIRE(mark.format_to(nullptr, 0) == length);
+    }
+
+    SECTION("Stream and string")
+    {
+        mark += std::chrono::microseconds(20);
+        mark += std::chrono::microseconds(40);
+
+        std::ostringstream out;
+        out << mark;
+        REQUIRE(out.str() == "total 60.00us, 2 iterations, min/avg/max 20.00us/30.00us/40.00us");
+        REQUIRE(mark.to_string() == out.str());
+    }
+}
+
+TEST_CASE("Mark bulk aggregation", "[mark][simd]")
+{
+    std::mt19937_64 engine(42);
+    std::uniform_int_distribution<int64_t> dist(0, 1000000);
+
+    std::vector<int64_t> values(10000 + 3);
+    for (auto& value : values) value = dist(engine);
+
+    Mark scalar;
+    for (auto value : values) scalar += std::chrono::nanoseconds(value);
+
+    SECTION("Matches one at a time aggregation")
+    {
+        Mark bulk;
+        bulk.add_bulk(values.data(), values.size());
+
+        REQUIRE(bulk.iterations() == scalar.iterations());
+        REQUIRE(bulk.as_nanoseconds() == scalar.as_nanoseconds());
+        REQUIRE(bulk.minimal().as_nanoseconds() == scalar.minimal().as_nanoseconds());
+        REQUIRE(bulk.maximal().as_nanoseconds() == scalar.maximal().as_nanoseconds());
+    }
+
+    SECTION("Every instruction set agrees")
+    {
+        for (auto isa : { simd::Isa::scalar, simd::Isa::avx2, simd::Isa::avx512 })
+        {
+            if (!simd::supported(isa)) continue;
+
+            for (size_t n : { size_t(0), size_t(1), size_t(7), size_t(9), values.size() })
+            {
+                auto expected = simd::summarize_scalar(values.data(), n);
+                auto actual = simd::summarize(values.data(), n, isa);
+                REQUIRE(actual.sum == expected.sum);
+                REQUIRE(actual.min == expected.min);
+                REQUIRE(actual.max == expected.max);
+            }
+        }
+    }
+
+    SECTION("Overflowing blocks")
+    {
+        int overflows = 0;
+        Mark bulk([&overflows](const Mark&) { ++overflows; });
+
+        std::vector<int64_t> large(3, std::chrono::nanoseconds::max().count() / 2);
+        bulk.add_bulk(large.data(), large.size());
+
+        REQUIRE(overflows == 1);
+        REQUIRE(bulk.iterations() == 1);
+        REQUIRE(bulk.as_nanoseconds() == large[0]);
+    }
+}
+
 TEST_CASE("Mark overflow protection", "[mark]")
 {
     Mark mark;
@@ -222,6 +344,32 @@ TEST_CASE("Thread benchmarking", "[benchmark][thread]")
 
 #endif // BENCHMARK_THREAD_CPUTIME
 
+#ifdef BENCHMARK_PROCESS_CPUTIME
+
+TEST_CASE("Process clock supported", "[benchmark][process]")
+{
+    REQUIRE(process_clock::supported());
+}
+
+TEST_CASE("Process benchmarking", "[benchmark][process]")
+{
+    std::chrono::milliseconds busy(20);
+    auto spin = [busy]() {
+        auto until = std::chrono::steady_clock::now() + busy;
+        while (std::chrono::steady_clock::now() < until) {}
+    };
+
+    // CPU time spent by any thread of the process is counted
+    auto mark = Process::mark([spin]() {
+        std::thread worker(spin);
+        worker.join();
+    });
+
+    REQUIRE(mark.as_milliseconds() >= busy.count() / 2);
+}
+
+#endif // BENCHMARK_PROCESS_CPUTIME
+
 TEST_CASE("Scoped benchmarking", "[benchmark]")
 {
     Mark mark;
@@ -267,3 +415,142 @@ TEST_CASE("Scoped benchmarking", "[benchmark]")
     REQUIRE(total_ms >= min_delay * iterations);
     REQUIRE(total_ms <  max_delay * iterations);
 }
+
+TEST_CASE("Paused benchmarking", "[benchmark]")
+{
+    Mark mark;
+    std::chrono::milliseconds delay(30);
+
+    SECTION("Paused time is excluded")
+    {
+        Bench::Probe probe(mark);
+        std::this_thread::sleep_for(delay);
+        probe.pause();
+        std::this_thread::sleep_for(4 * delay);
+        probe.resume();
+        std::this_thread::sleep_for(delay);
+        probe.done();
+    }
+
+    SECTION("Redundant pauses and resumes are ignored")
+    {
+        Bench::Probe probe(mark);
+        probe.resume();
+        std::this_thread::sleep_for(delay);
+        probe.pause();
+        probe.pause();
+        std::this_thread::sleep_for(4 * delay);
+        probe.resume();
+        std::this_thread::sleep_for(delay);
+        probe.resume();
+    }
+
+    SECTION("Done while paused")
+    {
+        Bench::Probe probe(mark);
+        std::this_thread::sleep_for(2 * delay);
+        probe.pause();
+        std::this_thread::sleep_for(4 * delay);
+    }
+
+    REQUIRE(mark.iterations() == 1);
+    REQUIRE(mark.as_milliseconds() >= 2 * delay.count());
+    REQUIRE(mark.as_milliseconds() <  4 * delay.count());
+}
+
+TEST_CASE("Lap benchmarking", "[benchmark]")
+{
+    Mark mark;
+    Mark first;
+    Mark second;
+    std::chrono::milliseconds delay(30);
+
+    {
+        Bench::Probe probe(mark);
+        std::this_thread::sleep_for(delay);
+        probe.lap(first);
+        probe.pause();
+        std::this_thread::sleep_for(4 * delay);
+        probe.resume();
+        std::this_thread::sleep_for(2 * delay);
+        probe.lap(second);
+        probe.done();
+        probe.lap(second);
+    }
+
+    REQUIRE(first.iterations() == 1);
+    REQUIRE(first.as_milliseconds() >= delay.count());
+    REQUIRE(first.as_milliseconds() <  2 * delay.count());
+
+    REQUIRE(second.iterations() == 1);
+    REQUIRE(second.as_milliseconds() >= 2 * delay.count());
+    REQUIRE(second.as_milliseconds() <  3 * delay.count());
+
+    REQUIRE(mark.iterations() == 1);
+    REQUIRE(mark.as_milliseconds() >= 3 * delay.count());
+    REQUIRE(mark.as_milliseconds() <  4 * delay.count());
+}
+
+TEST_CASE("Probe footprint", "[benchmark]")
+{
+    // State, mark reference, a single timepoint and a lap offset
+    REQUIRE(sizeof(Bench::Probe) <= 4 * sizeof(int64_t));
+}
+
+TEST_CASE("Future benchmarking", "[benchmark][async]")
+{
+    std::chrono::milliseconds delay(30);
+
+    auto res = Bench::mark_async([delay]() {
+        return std::async(std::launch::async, [delay]() {
+            std::this_thread::sleep_for(delay);
+            return 42;
+        });
+    });
+
+    REQUIRE(res.first.iterations() == 1);
+    REQUIRE(res.first.as_milliseconds() >= delay.count());
+    REQUIRE(res.second.get() == 42);
+}
+
+TEST_CASE("Completion benchmarking", "[benchmark][async]")
+{
+    SyncMark mark;
+    std::chrono::milliseconds delay(30);
+    std::vector<std::thread> workers;
+
+    SECTION("Completed on another thread")
+    {
+        for (int i = 0; i < 4; ++i)
+        {
+            Bench::mark_async(mark, [&workers, delay](Bench::Completion done) {
+                workers.emplace_back([done, delay]() {
+                    std::this_thread::sleep_for(delay);
+                    done();
+                });
+            });
+        }
+
+        for (auto& worker : workers) worker.join();
+
+        auto snapshot = mark.snapshot();
+        REQUIRE(snapshot.iterations() == 4);
+        REQUIRE(snapshot.minimal().as_milliseconds() >= delay.count());
+    }
+
+    SECTION("Completed once")
+    {
+        Bench::mark_async(mark, [](Bench::Completion done, int times) {
+            for (int i = 0; i < times; ++i) done();
+        }, 3);
+
+        REQUIRE(mark.snapshot().iterations() == 1);
+    }
+
+    SECTION("Never completed")
+    {
+        Bench::mark_async(mark, [](Bench::Completion) {});
+
+        REQUIRE(mark.snapshot().iterations() == 0);
+    }
+}
@@ -0,0 +1,88 @@
+/*
+ *  Copyright 2016-present Daniel Trugman
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include "catch.hpp"
+
+#include <chrono>
+#include <string>
+
+#include "memory_profile.hpp"
+
+using namespace std;
+using namespace bm;
+
+TEST_CASE("Memory profiling", "[memory]")
+{
+    MemoryOptions opts;
+    opts.min_bytes = 4 << 10;
+    opts.max_bytes = 256 << 10;
+    opts.min_time = chrono::milliseconds(1);
+    opts.chase_steps = 1 << 12;
+
+    auto profile = profile_memory(opts);
+
+    SECTION("A point per working set")
+    {
+        REQUIRE(profile.points.size() == 4);
+        REQUIRE(profile.points.front().bytes == (4 << 10));
+        REQUIRE(profile.points.back().bytes == (256 << 10));
+
+        for (const auto& point : profile.points)
+        {
+            REQUIRE(point.read > 0);
+            REQUIRE(point.write > 0);
+            REQUIRE(point.copy > 0);
+            REQUIRE(point.latency_ns > 0);
+        }
+    }
+
+    SECTION("Ceilings by working set")
+    {
+        REQUIRE(profile.memory_bandwidth() == profile.points.back().read);
+        REQUIRE(profile.bandwidth(1) == profile.points.front().read);
+        REQUIRE(profile.bandwidth(5 << 10) == profile.points[1].read);
+        REQUIRE(profile.bandwidth(1 << 30) == profile.memory_bandwidth());
+    }
+
+    SECTION("Putting a Mark into context")
+    {
+        Mark mark(chrono::seconds(1));
+        mark.add_bytes(static_cast<uint64_t>(profile.memory_bandwidth() / 2));
+
+        REQUIRE(profile.utilization(mark) == Approx(0.5).epsilon(0.01));
+        REQUIRE(profile.context(mark).find("50.0% of memory bandwidth") == 0);
+        REQUIRE(profile.context(mark, 4 << 10).find("of 4KiB working set bandwidth") != string::npos);
+    }
+
+    SECTION("The curve")
+    {
+        ostringstream out;
+        out << profile;
+        REQUIRE(out.str().find("256KiB") != string::npos);
+    }
+}
+
+TEST_CASE("Memory profile without points", "[memory]")
+{
+    MemoryProfile profile;
+    Mark mark(chrono::seconds(1));
+    mark.add_bytes(1000);
+
+    REQUIRE(profile.memory_bandwidth() == 0);
+    REQUIRE(profile.utilization(mark) == 0);
+    REQUIRE(MemoryProfile::format_bytes(3 << 20) == "3MiB");
+    REQUIRE(MemoryProfile::format_bytes(1000) == "1000B");
+}
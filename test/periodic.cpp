@@ -0,0 +1,195 @@
+/*
+ *  Copyright 2016-present Daniel Trugman
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include "catch.hpp"
+
+#include <chrono>
+#include <thread>
+#include <vector>
+#include <sstream>
+#include <mutex>
+#include <atomic>
+
+#include "benchmark.hpp"
+#include "periodic.hpp"
+
+using namespace std;
+using namespace bm;
+
+TEST_CASE("Atomic mark", "[periodic]")
+{
+    AtomicMark mark;
+
+    SECTION("Empty")
+    {
+        auto snapshot = mark.snapshot();
+        REQUIRE(snapshot.iterations() == 0);
+        REQUIRE(snapshot.as_nanoseconds() == 0);
+    }
+
+    SECTION("Aggregation")
+    {
+        mark += chrono::nanoseconds(30);
+        mark += chrono::nanoseconds(10);
+        mark += chrono::nanoseconds(20);
+        mark.add_bytes(100);
+        mark.add_items(3);
+
+        auto snapshot = mark.snapshot();
+        REQUIRE(snapshot.iterations() == 3);
+        REQUIRE(snapshot.as_nanoseconds() == 60);
+        REQUIRE(snapshot.minimal().as_nanoseconds() == 10);
+        REQUIRE(snapshot.maximal().as_nanoseconds() == 30);
+        REQUIRE(snapshot.bytes() == 100);
+        REQUIRE(snapshot.items() == 3);
+    }
+
+    SECTION("Exchange resets")
+    {
+        mark += chrono::nanoseconds(50);
+
+        auto first = mark.exchange();
+        REQUIRE(first.iterations() == 1);
+        REQUIRE(first.as_nanoseconds() == 50);
+
+        mark += chrono::nanoseconds(5);
+
+        auto second = mark.exchange();
+        REQUIRE(second.iterations() == 1);
+        REQUIRE(second.minimal().as_nanoseconds() == 5);
+        REQUIRE(second.maximal().as_nanoseconds() == 5);
+
+        REQUIRE(mark.exchange().iterations() == 0);
+    }
+
+    SECTION("Probe")
+    {
+        {
+            Bench::AtomicProbe probe(mark);
+            probe.items(1);
+        }
+        REQUIRE(mark.snapshot().iterations() == 1);
+        REQUIRE(mark.snapshot().items() == 1);
+    }
+}
+
+TEST_CASE("Periodic reporting", "[periodic]")
+{
+    AtomicMark mark;
+    mutex lock;
+    vector<Interval> intervals;
+
+    PeriodicReporter reporter(chrono::milliseconds(10), [&](const Interval& interval) {
+        lock_guard<mutex> guard(lock);
+        intervals.push_back(interval);
+    });
+    reporter.add("work", mark);
+
+    SECTION("Concurrent writers lose nothing")
+    {
+        static const int THREADS = 4;
+        static const int SAMPLES = 20000;
+
+        reporter.start();
+        vector<thread> writers;
+        for (int i = 0; i < THREADS; ++i)
+        {
+            writers.emplace_back([&mark]() {
+                for (int j = 0; j < SAMPLES; ++j) mark += chrono::nanoseconds(2);
+            });
+        }
+        for (auto& writer : writers) writer.join();
+        this_thread::sleep_for(chrono::milliseconds(30));
+        reporter.stop();
+
+        REQUIRE(intervals.size() >= 2);
+
+        int64_t iterations = 0, total = 0;
+        for (const auto& interval : intervals)
+        {
+            REQUIRE(interval.entries.size() == 1);
+            REQUIRE(interval.entries[0].name == "work");
+            iterations += interval.entries[0].mark.iterations();
+            total      += interval.entries[0].mark.as_nanoseconds();
+        }
+        REQUIRE(iterations == THREADS * SAMPLES);
+        REQUIRE(total == 2 * THREADS * SAMPLES);
+    }
+
+    SECTION("Intervals are deltas")
+    {
+        mark += chrono::microseconds(1);
+        reporter.report();
+        mark += chrono::microseconds(2);
+        reporter.report();
+
+        REQUIRE(intervals.size() == 2);
+        REQUIRE(intervals[0].entries[0].mark.as_microseconds() == 1);
+        REQUIRE(intervals[1].entries[0].mark.as_microseconds() == 2);
+    }
+}
+
+TEST_CASE("Periodic reports are serialized", "[periodic]")
+{
+    AtomicMark mark;
+    atomic<int> inside(0);
+    atomic<bool> overlapped(false);
+    int reports = 0;
+    Mark::nanoseconds elapsed(0);
+
+    // Deliberately unsynchronized, like an ostream sink
+    PeriodicReporter reporter(chrono::milliseconds(1), [&](const Interval& interval) {
+        if (++inside > 1) overlapped = true;
+        ++reports;
+        elapsed += interval.elapsed;
+        this_thread::sleep_for(chrono::microseconds(100));
+        --inside;
+    });
+    reporter.add("work", mark);
+
+    auto start = chrono::steady_clock::now();
+    reporter.start();
+    vector<thread> reporters;
+    for (int i = 0; i < 2; ++i)
+    {
+        reporters.emplace_back([&reporter]() {
+            for (int j = 0; j < 50; ++j) reporter.report();
+        });
+    }
+    for (auto& thread : reporters) thread.join();
+    reporter.stop();
+    auto total = chrono::steady_clock::now() - start;
+
+    REQUIRE_FALSE(overlapped);
+    REQUIRE(reports >= 101);
+    // In order, so the intervals tile the run without overlapping
+    REQUIRE(elapsed <= total);
+}
+
+TEST_CASE("Periodic stream sink", "[periodic]")
+{
+    AtomicMark mark;
+    ostringstream out;
+
+    PeriodicReporter reporter(chrono::seconds(10), PeriodicReporter::stream_sink(out));
+    reporter.add("requests", mark);
+
+    mark += chrono::microseconds(20);
+    reporter.report();
+
+    REQUIRE(out.str().find("requests: total 20.00us, 1 iterations") == 0);
+    REQUIRE(out.str().find("/s\n") != string::npos);
+}
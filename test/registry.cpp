@@ -0,0 +1,227 @@
+/*
+ *  Copyright 2016-present Daniel Trugman
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include "catch.hpp"
+
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "registry.hpp"
+#include "reporter.hpp"
+
+using namespace std;
+using namespace bm;
+
+static int registry_calls = 0;
+
+BM_REGISTER("registry/plain", []() { return ++registry_calls; });
+
+BM_REGISTER_FIXTURE("registry/fixture",
+    []() { return std::string("fixture"); },
+    [](std::string& state) { return state.size(); },
+    [](std::string&) {});
+
+static Sweep registry_sweep()
+{
+    Sweep sweep;
+    sweep.args = product({ { 16, 32, 64 } });
+    return sweep;
+}
+
+BM_REGISTER_SWEEP("registry/sweep", registry_sweep(),
+    [](const Args& args) { return std::string(args[0], 'x'); });
+
+BM_REGISTER_SWEEP_FIXTURE("registry/sweep_fixture", registry_sweep(),
+    [](const Args& args) { return std::string(args[0], 'x'); },
+    [](std::string& state) { return state.find('y'); },
+    [](std::string&) {});
+
+TEST_CASE("Registration", "[registry]")
+{
+    auto benchmarks = Registry::instance().matching("^registry/");
+    REQUIRE(benchmarks.size() == 4);
+    REQUIRE(benchmarks[0]->name == "registry/plain");
+    REQUIRE(benchmarks[3]->name == "registry/sweep_fixture");
+
+    REQUIRE(Registry::instance().matching("sweep").size() == 2);
+    REQUIRE(Registry::instance().matching("^registry/plain$").size() == 1);
+    REQUIRE(Registry::instance().matching("no such benchmark").empty());
+
+    // The macros register the flags of this source
+    for (auto benchmark : benchmarks)
+    {
+        REQUIRE(benchmark->flags == BENCHMARK_CXX_FLAGS);
+    }
+}
+
+TEST_CASE("Running registered benchmarks", "[registry]")
+{
+    Options opts;
+    opts.iterations = 10;
+
+    SECTION("Plain")
+    {
+        registry_calls = 0;
+        auto report = Registry::instance().matching("^registry/plain$").front()->run(opts, ClockType::steady);
+        REQUIRE(report.name == "registry/plain");
+        REQUIRE(report.results.size() == 1);
+        REQUIRE(report.results.front().mark.iterations() == 10);
+        REQUIRE(registry_calls > 10); // Including the calibration calls
+    }
+
+    SECTION("Sweep")
+    {
+        auto report = Registry::instance().matching("^registry/sweep$").front()->run(opts, ClockType::steady);
+        REQUIRE(report.results.size() == 3);
+        REQUIRE(id(report.results.back()) == "registry/sweep/64");
+    }
+
+#ifdef BENCHMARK_THREAD_CPUTIME
+    SECTION("Thread clock")
+    {
+        auto report = Registry::instance().matching("^registry/sweep_fixture$").front()->run(opts, ClockType::thread);
+        REQUIRE(report.results.size() == 3);
+        REQUIRE(report.results.front().mark.iterations() == 10);
+    }
+#endif // BENCHMARK_THREAD_CPUTIME
+}
+
+TEST_CASE("Console reporting", "[reporter]")
+{
+    std::ostringstream out;
+    auto reporter = make_reporter("console", out);
+    REQUIRE(reporter);
+    REQUIRE_FALSE(make_reporter("no such format", out));
+
+    Result result;
+    result.name = "console";
+    result.args = { 1, 2 };
+    record(result, std::chrono::nanoseconds(1000), 10);
+
+    reporter->begin();
+    reporter->report(result);
+    reporter->end();
+    REQUIRE(out.str().find("console/1/2: 100ns per iteration") == 0);
+}
+
+static Result reported()
+{
+    Result result;
+    result.name = "reported \"quoted\"";
+    result.args = { 8 };
+    for (int64_t ns = 100; ns <= 1000; ns += 100)
+    {
+        record(result, std::chrono::nanoseconds(ns * 10), 10);
+    }
+    result.mark.add_bytes(5500);
+    result.threads = 2;
+    return result;
+}
+
+TEST_CASE("JSON reporting", "[reporter]")
+{
+    Context context;
+    context.cpu = "Test CPU";
+    context.clock = "steady_clock";
+
+    std::ostringstream out;
+    auto reporter = make_reporter("json", out, context);
+    REQUIRE(reporter);
+
+    reporter->begin();
+    reporter->report(reported());
+
+    Report report;
+    report.name = "scaling";
+    for (int64_t n = 1; n <= 4; ++n)
+    {
+        Result result;
+        result.name = "scaling";
+        result.args = { n * 1000 };
+        record(result, std::chrono::nanoseconds(n * 1000), 1);
+        report.results.push_back(result);
+    }
+    reporter->summarize(report);
+    reporter->end();
+
+    Json json;
+    REQUIRE(Json::parse(out.str(), json));
+    REQUIRE(json["context"]["cpu"].as_string() == "Test CPU");
+    REQUIRE(json["context"]["clock"].as_string() == "steady_clock");
+
+    const auto& benchmarks = json["benchmarks"].as_array();
+    REQUIRE(benchmarks.size() == 2);
+    REQUIRE(benchmarks[0]["type"].as_string() == "result");
+    REQUIRE(benchmarks[0]["id"].as_string() == "reported \"quoted\"/8/threads:2");
+    REQUIRE(benchmarks[0]["iterations"].as_number() == 100);
+    REQUIRE(benchmarks[0]["min_ns"].as_number() == 100);
+    REQUIRE(benchmarks[0]["max_ns"].as_number() == 1000);
+    REQUIRE(benchmarks[0]["avg_ns"].as_number() == Approx(550));
+    REQUIRE(benchmarks[0]["stddev_ns"].as_number() > 0);
+    REQUIRE(benchmarks[0]["p50_ns"].as_number() == Approx(500).epsilon(0.04));
+    REQUIRE(benchmarks[0]["p99_ns"].as_number() == Approx(1000).epsilon(0.04));
+    REQUIRE(benchmarks[0]["iterations_per_second"].as_number() == Approx(1e9 / 550));
+    REQUIRE(benchmarks[0]["bytes"].as_number() == 5500);
+    REQUIRE(benchmarks[0]["bytes_per_second"].as_number() == Approx(2 * 1e9 / 10));
+    REQUIRE(benchmarks[0]["items_per_second"].as_number() == 0);
+    REQUIRE(benchmarks[1]["type"].as_string() == "complexity");
+    REQUIRE(benchmarks[1]["complexity"].as_string() == "O(n)");
+
+    SECTION("Empty suite")
+    {
+        std::ostringstream empty;
+        auto other = make_reporter("json", empty, context);
+        other->begin();
+        other->end();
+        REQUIRE(Json::parse(empty.str(), json));
+        REQUIRE(json["benchmarks"].as_array().empty());
+    }
+}
+
+TEST_CASE("CSV reporting", "[reporter]")
+{
+    Context context;
+    context.compiler = "test compiler";
+
+    std::ostringstream out;
+    auto reporter = make_reporter("csv", out, context);
+    REQUIRE(reporter);
+
+    reporter->begin();
+    reporter->report(reported());
+    reporter->end();
+
+    std::istringstream in(out.str());
+    std::string line;
+    std::vector<std::string> rows;
+    while (std::getline(in, line))
+    {
+        if (line.compare(0, 2, "# ") == 0)
+        {
+            if (line.compare(0, 11, "# compiler:") == 0)
+            {
+                REQUIRE(line == "# compiler: test compiler");
+            }
+            continue;
+        }
+        rows.push_back(line);
+    }
+
+    REQUIRE(rows.size() == 2);
+    REQUIRE(rows[0].compare(0, 8, "id,name,") == 0);
+    REQUIRE(rows[1].find("\"reported \"\"quoted\"\"/8/threads:2\",\"reported \"\"quoted\"\"\",2,100,") == 0);
+}
@@ -0,0 +1,111 @@
+/*
+ *  Copyright 2016-present Daniel Trugman
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include "catch.hpp"
+
+#include "resource.hpp"
+
+#ifdef BENCHMARK_RUSAGE
+
+#include <chrono>
+#include <thread>
+#include <vector>
+#include <sstream>
+
+#include <sys/mman.h>
+#include <unistd.h>
+
+using namespace std;
+using namespace bm;
+
+TEST_CASE("Resource deltas", "[resource]")
+{
+    ResourceMark mark;
+
+    SECTION("Sleeping is a voluntary context switch")
+    {
+        {
+            ResourceProbe probe(mark, ResourceScope::thread);
+            this_thread::sleep_for(chrono::milliseconds(5));
+        }
+
+        REQUIRE(mark.iterations() == 1);
+        REQUIRE(mark.total().voluntary_switches >= 1);
+    }
+
+    SECTION("Touching fresh pages faults")
+    {
+        static const size_t PAGES = 64;
+        auto page = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+
+        auto memory = mmap(nullptr, PAGES * page, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        REQUIRE(memory != MAP_FAILED);
+
+        mark_resources(mark, [&]() {
+            for (size_t i = 0; i < PAGES; ++i) static_cast<char*>(memory)[i * page] = 1;
+        });
+        munmap(memory, PAGES * page);
+
+        REQUIRE(mark.iterations() == 1);
+        REQUIRE(mark.total().minor_faults >= static_cast<int64_t>(PAGES) / 2);
+    }
+
+    SECTION("CPU time")
+    {
+        chrono::milliseconds busy(20);
+        auto result = mark_resources(mark, [busy]() {
+            auto until = chrono::steady_clock::now() + busy;
+            while (chrono::steady_clock::now() < until) {}
+            return 7;
+        });
+
+        REQUIRE(result == 7);
+        REQUIRE((mark.total().user + mark.total().system) >= busy / 2);
+        REQUIRE(mark.user().iterations() == 1);
+    }
+}
+
+TEST_CASE("Resource aggregation", "[resource]")
+{
+    Resources delta;
+    delta.user = chrono::microseconds(10);
+    delta.minor_faults = 2;
+    delta.involuntary_switches = 1;
+
+    ResourceMark mark;
+    mark += delta;
+    mark += delta;
+
+    ResourceMark other;
+    other += delta;
+    mark += other;
+
+    REQUIRE(mark.iterations() == 3);
+    REQUIRE(mark.total().user == chrono::microseconds(30));
+    REQUIRE(mark.user().average().as_microseconds() == 10);
+    REQUIRE(mark.total().minor_faults == 6);
+    REQUIRE(mark.total().involuntary_switches == 3);
+
+    ostringstream out;
+    out << mark;
+    REQUIRE(out.str().find("3 iterations, user 30000ns") == 0);
+
+    mark.clear();
+    REQUIRE(mark.iterations() == 0);
+    REQUIRE(mark.total().minor_faults == 0);
+}
+
+#endif // BENCHMARK_RUSAGE
@@ -0,0 +1,177 @@
+/*
+ *  Copyright 2016-present Daniel Trugman
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include "catch.hpp"
+
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include "benchmark.hpp"
+#include "ring.hpp"
+
+using namespace std;
+using namespace bm;
+
+namespace {
+
+vector<int64_t> drain_values(SampleRing& ring)
+{
+    vector<int64_t> values;
+    ring.drain([&values](uint32_t, SampleRing::Kind, int64_t value) { values.push_back(value); });
+    return values;
+}
+
+} // namespace
+
+TEST_CASE("Sample ring", "[ring]")
+{
+    SECTION("Capacity is a power of two")
+    {
+        SampleRing ring(5, Backpressure::drop);
+        REQUIRE(ring.capacity() == 8);
+    }
+
+    SECTION("First in, first out")
+    {
+        SampleRing ring(8, Backpressure::drop);
+        REQUIRE(ring.push(3, SampleRing::Kind::duration, 10));
+        REQUIRE(ring.push(4, SampleRing::Kind::items, 20));
+
+        vector<uint32_t> ids;
+        vector<SampleRing::Kind> kinds;
+        auto count = ring.drain([&](uint32_t id, SampleRing::Kind kind, int64_t) {
+            ids.push_back(id);
+            kinds.push_back(kind);
+        });
+
+        REQUIRE(count == 2);
+        REQUIRE(ids == vector<uint32_t>({ 3, 4 }));
+        REQUIRE(kinds[0] == SampleRing::Kind::duration);
+        REQUIRE(kinds[1] == SampleRing::Kind::items);
+        REQUIRE(drain_values(ring).empty());
+    }
+
+    SECTION("Drop when full")
+    {
+        SampleRing ring(4, Backpressure::drop);
+        for (int64_t i = 0; i < 6; ++i) ring.push(0, SampleRing::Kind::duration, i);
+
+        REQUIRE(ring.lost() == 2);
+        REQUIRE(drain_values(ring) == vector<int64_t>({ 0, 1, 2, 3 }));
+
+        REQUIRE(ring.push(0, SampleRing::Kind::duration, 6));
+        REQUIRE(drain_values(ring) == vector<int64_t>({ 6 }));
+    }
+
+    SECTION("Overwrite when full")
+    {
+        SampleRing ring(4, Backpressure::overwrite);
+        for (int64_t i = 0; i < 6; ++i) REQUIRE(ring.push(0, SampleRing::Kind::duration, i));
+
+        REQUIRE(drain_values(ring) == vector<int64_t>({ 2, 3, 4, 5 }));
+        REQUIRE(ring.lost() == 2);
+    }
+
+    SECTION("Concurrent producer and consumer")
+    {
+        static const int64_t SAMPLES = 100000;
+        SampleRing ring(64, Backpressure::drop);
+
+        thread producer([&ring]() {
+            for (int64_t i = 0; i < SAMPLES; ++i)
+            {
+                while (!ring.push(0, SampleRing::Kind::duration, i)) this_thread::yield();
+            }
+        });
+
+        int64_t expected = 0;
+        bool ordered = true;
+        while (expected < SAMPLES)
+        {
+            ring.drain([&](uint32_t, SampleRing::Kind, int64_t value) {
+                ordered = ordered && (value == expected);
+                ++expected;
+            });
+            this_thread::yield();
+        }
+        producer.join();
+
+        REQUIRE(ordered);
+    }
+}
+
+TEST_CASE("Ring aggregation", "[ring]")
+{
+    RingAggregator aggregator(1024, Backpressure::drop);
+    auto sink = aggregator.channel("work");
+    auto other = aggregator.channel("other");
+
+    SECTION("Probes from several threads")
+    {
+        static const int THREADS = 4;
+        static const int SAMPLES = 500;
+
+        vector<thread> threads;
+        for (int i = 0; i < THREADS; ++i)
+        {
+            threads.emplace_back([&sink]() {
+                for (int j = 0; j < SAMPLES; ++j)
+                {
+                    Bench::BasicProbe<RingAggregator::Sink> probe(sink);
+                    probe.items(1);
+                }
+            });
+        }
+        for (auto& t : threads) t.join();
+
+        aggregator.drain();
+        auto mark = aggregator.mark(sink);
+        REQUIRE(mark.iterations() == THREADS * SAMPLES);
+        REQUIRE(mark.items() == THREADS * SAMPLES);
+        REQUIRE(aggregator.histogram(sink).count() == THREADS * SAMPLES);
+        REQUIRE(aggregator.mark(other).iterations() == 0);
+        REQUIRE(aggregator.lost() == 0);
+    }
+
+    SECTION("Background draining")
+    {
+        aggregator.start(chrono::milliseconds(1));
+        for (int i = 0; i < 5000; ++i)
+        {
+            sink += chrono::nanoseconds(10);
+            if (i % 500 == 0) this_thread::sleep_for(chrono::milliseconds(2));
+        }
+        aggregator.stop();
+
+        auto mark = aggregator.mark(sink);
+        REQUIRE(mark.iterations() + static_cast<int64_t>(aggregator.lost()) == 5000);
+        REQUIRE(mark.as_nanoseconds() == 10 * mark.iterations());
+    }
+
+    SECTION("Channels are kept apart")
+    {
+        sink += chrono::microseconds(1);
+        other += chrono::microseconds(5);
+        other.add_bytes(64);
+        aggregator.drain();
+
+        REQUIRE(aggregator.mark(sink).as_microseconds() == 1);
+        REQUIRE(aggregator.mark(other).as_microseconds() == 5);
+        REQUIRE(aggregator.mark(other).bytes() == 64);
+        REQUIRE(aggregator.mark(sink).bytes() == 0);
+    }
+}
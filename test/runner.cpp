@@ -0,0 +1,412 @@
+/*
+ *  Copyright 2016-present Daniel Trugman
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include "catch.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include <atomic>
+#include <limits>
+#include <memory>
+#include <sstream>
+
+#include "benchmark.hpp"
+#include "runner.hpp"
+
+using namespace std;
+using namespace bm;
+
+TEST_CASE("Batch aggregation", "[mark]")
+{
+    Mark mark;
+    mark.add_batch(std::chrono::nanoseconds(1000), 10);
+    mark.add_batch(std::chrono::nanoseconds(3000), 10);
+
+    REQUIRE(mark.iterations() == 20);
+    REQUIRE(mark.as_nanoseconds() == 4000);
+    REQUIRE(mark.minimal().as_nanoseconds() == 100);
+    REQUIRE(mark.maximal().as_nanoseconds() == 300);
+
+    mark.add_batch(std::chrono::nanoseconds(1000), 0);
+    REQUIRE(mark.iterations() == 20);
+}
+
+TEST_CASE("Running", "[runner]")
+{
+    Options opts;
+
+    SECTION("Exact iterations")
+    {
+        uint64_t calls = 0;
+        opts.iterations = 1000;
+        auto result = Runner::run("count", [&calls]() { ++calls; }, opts);
+
+        REQUIRE(result.name == "count");
+        REQUIRE(result.mark.iterations() == 1000);
+        REQUIRE(calls > 1000); // Including the calibration calls
+    }
+
+    SECTION("Slow first call")
+    {
+        // A first call paying for a one-off cost must not leave the fast
+        // calls that follow timed one at a time
+        bool first = true;
+        opts.min_time = std::chrono::milliseconds(20);
+        auto result = Runner::run("first", [&first]() {
+            if (first) std::this_thread::sleep_for(std::chrono::milliseconds(5));
+            first = false;
+        }, opts);
+
+        REQUIRE(result.mark.iterations() > 100 * result.batches);
+    }
+
+    SECTION("Minimal time")
+    {
+        opts.min_time = std::chrono::milliseconds(20);
+        auto result = Runner::run("sum", []() {
+            int sum = 0;
+            for (int i = 0; i < 100; ++i) sum += i;
+            return sum;
+        }, opts);
+
+        REQUIRE(result.mark.as_milliseconds() >= 20);
+        REQUIRE(result.batches > 0);
+        REQUIRE(result.batches < result.mark.iterations());
+    }
+}
+
+TEST_CASE("Sample capture", "[runner]")
+{
+    Options opts;
+    opts.iterations = 500;
+
+    SECTION("Every iteration on its own")
+    {
+        opts.capture = Options::Capture::iterations;
+        auto result = Runner::run("count", []() { return 1; }, opts);
+
+        REQUIRE(result.batches == 500);
+        REQUIRE(result.samples.size() == 500);
+        REQUIRE(result.samples.capacity() == 500); // Preallocated
+        REQUIRE(result.histogram.count() == 500);
+    }
+
+    SECTION("Fixtures too")
+    {
+        opts.capture = Options::Capture::iterations;
+        auto result = Runner::fixture("vector", []() { return vector<int>(10); },
+                                      [](vector<int>& v) { v.push_back(1); },
+                                      [](vector<int>&) {}, opts);
+
+        REQUIRE(result.samples.size() == 500);
+    }
+
+    SECTION("Rejecting outliers")
+    {
+        opts.capture = Options::Capture::iterations;
+        opts.reject_outliers = true;
+
+        int calls = 0;
+        auto result = Runner::run("stall", [&calls]() {
+            processed_items(1);
+            if (++calls % 100 == 0) this_thread::sleep_for(chrono::milliseconds(2));
+        }, opts);
+
+        REQUIRE(result.outliers >= 4);
+        REQUIRE(result.samples.size() == 500 - result.outliers);
+        REQUIRE(static_cast<uint64_t>(result.mark.iterations()) == 500 - result.outliers);
+        REQUIRE(result.mark.maximal().as_milliseconds() < 2);
+        REQUIRE(result.histogram.count() == 500 - result.outliers);
+        REQUIRE(result.mark.items() == static_cast<uint64_t>(result.mark.iterations())); // Dropped with their batches
+    }
+}
+
+TEST_CASE("Allocation counting", "[runner]")
+{
+    Options opts;
+    opts.iterations = 100;
+
+    SECTION("Within the timed region")
+    {
+        auto result = Runner::run("allocate", []() {
+            unique_ptr<int> value(new int(1));
+            do_not_optimize(value.get()); // Or the allocation may be elided
+            return *value;
+        }, opts);
+
+        REQUIRE(result.allocations == 100);
+    }
+
+    SECTION("Not in setup or teardown")
+    {
+        auto result = Runner::fixture("fill", []() { return vector<int>(100); },
+                                      [](vector<int>& v) { v.assign(10, 1); },
+                                      [](vector<int>& v) { v.push_back(1); }, opts);
+
+        REQUIRE(result.allocations == 0);
+    }
+
+    SECTION("Reported per iteration")
+    {
+        auto result = Runner::run("allocate", []() {
+            vector<int> values(10);
+            do_not_optimize(values.data());
+            return values.size();
+        }, opts);
+
+        ostringstream out;
+        out << result;
+        REQUIRE(out.str().find(", 1 allocations per iteration") != string::npos);
+    }
+}
+
+TEST_CASE("Fixture running", "[runner]")
+{
+    Options opts;
+    std::chrono::milliseconds delay(1);
+
+    int setups = 0;
+    int teardowns = 0;
+    int bodies = 0;
+
+    opts.iterations = 50;
+    auto result = Runner::fixture("fixture",
+        [&]() { ++setups; std::this_thread::sleep_for(delay); return std::vector<int>(100, 1); },
+        [&](std::vector<int>& v) { ++bodies; v.push_back(2); return v.size(); },
+        [&](std::vector<int>& v) { ++teardowns; REQUIRE(v.size() == 101); std::this_thread::sleep_for(delay); },
+        opts);
+
+    REQUIRE(result.mark.iterations() == 50);
+    REQUIRE(setups > 50); // Including the calibration calls
+    REQUIRE(bodies == setups);
+    REQUIRE(teardowns == setups);
+
+    // Neither setup nor teardown are measured
+    REQUIRE(result.mark.average().as_microseconds() < delay.count() * 1000);
+}
+
+TEST_CASE("Fixture batching", "[runner]")
+{
+    Options opts;
+    opts.iterations = 1000;
+    opts.max_batch = 64;
+
+    size_t alive = 0;
+    size_t peak = 0;
+    auto result = Runner::fixture("batches",
+        [&]() { peak = (std::max)(peak, ++alive); return 0; },
+        [](int& state) { ++state; },
+        [&](int&) { --alive; },
+        opts);
+
+    REQUIRE(result.mark.iterations() == 1000);
+    REQUIRE(result.batches >= 1000 / 64);
+    REQUIRE(peak <= 64);
+    REQUIRE(alive == 0);
+}
+
+TEST_CASE("Argument generation", "[runner]")
+{
+    SECTION("Range")
+    {
+        REQUIRE(range(1, 64) == std::vector<int64_t>({ 1, 8, 64 }));
+        REQUIRE(range(1 << 10, 1 << 13, 2) == std::vector<int64_t>({ 1 << 10, 1 << 11, 1 << 12, 1 << 13 }));
+        REQUIRE(range(3, 20, 2) == std::vector<int64_t>({ 3, 6, 12, 20 }));
+        REQUIRE(range(5, 5) == std::vector<int64_t>({ 5 }));
+
+        // Near the largest value, without overflowing past it
+        auto max = std::numeric_limits<int64_t>::max();
+        auto values = range(1, max, 1024);
+        REQUIRE(values.size() == 8);
+        REQUIRE(values[6] == static_cast<int64_t>(1) << 60);
+        REQUIRE(values.back() == max);
+        REQUIRE(range(max - 1, max) == std::vector<int64_t>({ max - 1, max }));
+    }
+
+    SECTION("Dense range")
+    {
+        REQUIRE(dense_range(1, 4) == std::vector<int64_t>({ 1, 2, 3, 4 }));
+        REQUIRE(dense_range(0, 10, 5) == std::vector<int64_t>({ 0, 5, 10 }));
+
+        auto max = std::numeric_limits<int64_t>::max();
+        REQUIRE(dense_range(max - 2, max, 2) == std::vector<int64_t>({ max - 2, max }));
+        REQUIRE(dense_range(max - 2, max, 4) == std::vector<int64_t>({ max - 2 }));
+    }
+
+    SECTION("Product")
+    {
+        auto args = product({ { 1, 2 }, { 10, 20, 30 } });
+        REQUIRE(args.size() == 6);
+        REQUIRE(args.front() == Args({ 1, 10 }));
+        REQUIRE(args[1] == Args({ 1, 20 }));
+        REQUIRE(args.back() == Args({ 2, 30 }));
+    }
+}
+
+TEST_CASE("Multithreaded running", "[runner]")
+{
+    Options opts;
+    opts.iterations = 100;
+    opts.threads = 4;
+
+    std::atomic<uint64_t> calls(0);
+    auto result = Runner::run("threads", [&calls]() { ++calls; }, opts);
+
+    REQUIRE(result.threads == 4);
+    REQUIRE(result.mark.iterations() == 4 * 100);
+    REQUIRE(calls > 4 * 100);
+}
+
+TEST_CASE("Sweeping", "[runner]")
+{
+    Options opts;
+    opts.min_time = std::chrono::milliseconds(5);
+
+    Sweep sweep;
+    sweep.args = product({ range(1 << 8, 1 << 12, 2) });
+    sweep.threads = { 1, 2 };
+
+    SECTION("Linear function")
+    {
+        auto report = Runner::sweep("accumulate", sweep, [](const Args& args) {
+            std::vector<int64_t> values(args[0], 1);
+            int64_t sum = 0;
+            for (auto value : values) sum += value;
+            return sum;
+        }, opts);
+
+        REQUIRE(report.name == "accumulate");
+        REQUIRE(report.results.size() == 2 * 5);
+        REQUIRE(report.results.front().args == Args({ 1 << 8 }));
+        REQUIRE(report.results.back().args == Args({ 1 << 12 }));
+        REQUIRE(report.results.back().threads == 2);
+
+        auto scaling = report.scaling();
+        REQUIRE(scaling.size() == 2);
+        REQUIRE(scaling.front().threads == 1);
+        REQUIRE(scaling.back().threads == 2);
+    }
+
+    SECTION("Fixture")
+    {
+        auto report = Runner::sweep_fixture("sort", sweep,
+            [](const Args& args) { return std::vector<int64_t>(args[0], 7); },
+            [](std::vector<int64_t>& values) { std::sort(values.begin(), values.end()); },
+            [](std::vector<int64_t>&) {},
+            opts);
+
+        REQUIRE(report.results.size() == 2 * 5);
+        for (const auto& result : report.results)
+        {
+            REQUIRE(result.mark.as_milliseconds() >= 5);
+        }
+    }
+}
+
+TEST_CASE("Throughput counting", "[runner]")
+{
+    SECTION("Marks")
+    {
+        Mark mark(std::chrono::milliseconds(500));
+        mark.add_bytes(1000).add_items(10);
+        REQUIRE(mark.bytes_per_second() == Approx(2000));
+        REQUIRE(mark.items_per_second() == Approx(20));
+
+        Mark other(std::chrono::milliseconds(500));
+        other.add_bytes(3000);
+        mark += other;
+        REQUIRE(mark.bytes() == 4000);
+        REQUIRE(mark.items() == 10);
+        REQUIRE(mark.bytes_per_second() == Approx(4000));
+
+        mark.clear();
+        REQUIRE(mark.bytes() == 0);
+        REQUIRE(mark.bytes_per_second() == 0);
+    }
+
+    SECTION("Overflowing marks restart counting")
+    {
+        Mark mark(std::chrono::nanoseconds::max());
+        mark.add_bytes(1000);
+
+        Mark other(std::chrono::seconds(1));
+        other.add_bytes(10);
+        mark += other;
+        REQUIRE(mark.bytes() == 10);
+    }
+
+    SECTION("Probes")
+    {
+        Mark mark;
+        {
+            Bench::Probe probe(mark);
+            probe.bytes(4096);
+            probe.items(2);
+            probe.items(3);
+        }
+        REQUIRE(mark.bytes() == 4096);
+        REQUIRE(mark.items() == 5);
+        REQUIRE(sizeof(Bench::Probe) <= 4 * sizeof(int64_t));
+    }
+
+    SECTION("Runner bodies")
+    {
+        Options opts;
+        opts.iterations = 100;
+
+        auto result = Runner::run("counted", []() { processed_bytes(64); processed_items(1); }, opts);
+        REQUIRE(result.mark.bytes() == 64 * 100); // Excluding the calibration call
+        REQUIRE(result.mark.items() == 100);
+        REQUIRE(result.mark.bytes_per_second() > 0);
+
+        auto fixture = Runner::fixture("counted",
+            []() { processed_items(1000); return 8; },  // Setup isn't timed, nor counted
+            [](int& bytes) { processed_bytes(bytes); },
+            [](int&) { processed_items(1000); },
+            opts);
+        REQUIRE(fixture.mark.bytes() == 8 * 100);
+        REQUIRE(fixture.mark.items() == 0);
+    }
+
+    SECTION("Time per item")
+    {
+        Options opts;
+        opts.iterations = 100;
+
+        auto single = Runner::run("single", []() { processed_items(1); }, opts);
+        auto many = Runner::run("many", []() { processed_items(1024); }, opts);
+
+        std::ostringstream out;
+        out << single << "\n" << many;
+        auto text = out.str();
+        auto per_item = text.find("ns per item");
+        REQUIRE(per_item != std::string::npos);
+        REQUIRE(per_item == text.rfind("ns per item"));
+        REQUIRE(per_item > text.find("many: ")); // Only where iterations process many items
+    }
+
+    SECTION("Runner threads")
+    {
+        Options opts;
+        opts.iterations = 100;
+        opts.threads = 4;
+
+        auto result = Runner::run("counted", []() { processed_items(1); }, opts);
+        REQUIRE(result.mark.items() == 4 * 100);
+    }
+}
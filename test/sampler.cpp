@@ -0,0 +1,95 @@
+/*
+ *  Copyright 2016-present Daniel Trugman
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include "catch.hpp"
+
+#include "sampler.hpp"
+
+#ifdef BENCHMARK_THREAD_CPUTIME
+
+#include <condition_variable>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <mutex>
+
+using namespace std;
+using namespace bm;
+
+TEST_CASE("CPU clock of another thread", "[sampler]")
+{
+    atomic<bool> stop(false);
+    thread worker([&stop]() { while (!stop) {} });
+
+    ThreadCpuClock cpu(worker);
+    REQUIRE(cpu.valid());
+
+    thread_clock::time_point before, after;
+    REQUIRE(cpu.now(before));
+    this_thread::sleep_for(chrono::milliseconds(30));
+    REQUIRE(cpu.now(after));
+
+    stop = true;
+    worker.join();
+
+    // Sharing a single core with this thread, the worker still got CPU time
+    REQUIRE(after > before);
+}
+
+TEST_CASE("Sampling worker threads", "[sampler]")
+{
+    atomic<bool> stop(false);
+    mutex lock;
+    condition_variable wakeup;
+
+    thread busy([&stop]() { while (!stop) {} });
+    thread idle([&]() {
+        unique_lock<mutex> guard(lock);
+        wakeup.wait(guard, [&stop]() { return stop.load(); });
+    });
+
+    ThreadSampler sampler;
+    REQUIRE(sampler.add("busy", busy));
+    REQUIRE(sampler.add("idle", idle));
+
+    this_thread::sleep_for(chrono::milliseconds(50));
+    sampler.sample();
+
+    const auto& workers = sampler.workers();
+    REQUIRE(workers.size() == 2);
+    REQUIRE(workers[0].alive);
+    REQUIRE(workers[0].mark.iterations() == 1);
+    REQUIRE(workers[0].mark.as_milliseconds() > workers[1].mark.as_milliseconds());
+    REQUIRE(workers[0].utilization > workers[1].utilization);
+
+    auto starved = sampler.starved(0.05);
+    REQUIRE(starved.size() == 1);
+    REQUIRE(starved[0]->name == "idle");
+
+    auto hot = sampler.hot(workers[0].utilization);
+    REQUIRE(hot.size() == 1);
+    REQUIRE(hot[0]->name == "busy");
+
+    {
+        lock_guard<mutex> guard(lock);
+        stop = true;
+    }
+    wakeup.notify_all();
+    busy.join();
+    idle.join();
+}
+
+#endif // BENCHMARK_THREAD_CPUTIME
@@ -0,0 +1,340 @@
+/*
+ *  Copyright 2016-present Daniel Trugman
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include "catch.hpp"
+
+#include <vector>
+#include <random>
+#include <chrono>
+#include <cmath>
+
+#include "statistics.hpp"
+#include "compare.hpp"
+#include "bootstrap.hpp"
+#include "random.hpp"
+
+using namespace std;
+using namespace bm;
+
+TEST_CASE("Descriptive statistics", "[statistics]")
+{
+    std::vector<double> samples = { 2, 4, 4, 4, 5, 5, 7, 9 };
+    REQUIRE(stats::mean(samples) == Approx(5));
+    REQUIRE(stats::variance(samples) == Approx(32.0 / 7));
+    REQUIRE(stats::stddev(std::vector<double>()) == 0);
+}
+
+TEST_CASE("Robust statistics", "[statistics]")
+{
+    std::vector<double> samples = { 9, 1, 2, 100, 3, 4, 5, 6, 7, 8 };
+
+    REQUIRE(stats::median(samples) == Approx(5.5));
+    REQUIRE(stats::quantile(samples, 0) == Approx(1));
+    REQUIRE(stats::quantile(samples, 1) == Approx(100));
+    REQUIRE(stats::quantile(samples, 0.25) == Approx(3.25));
+    REQUIRE(stats::iqr(samples) == Approx(7.75 - 3.25));
+    REQUIRE(stats::mad(samples) == Approx(2.5));
+    REQUIRE(stats::trimmed_mean(samples, 0.1) == Approx(5.5));
+    REQUIRE(stats::trimmed_mean(samples, 0) == Approx(14.5));
+
+    auto fences = stats::tukey_fences(samples);
+    REQUIRE(fences.lower == Approx(3.25 - 1.5 * 4.5));
+    REQUIRE(fences.upper == Approx(7.75 + 1.5 * 4.5));
+    REQUIRE(fences.contain(9));
+    REQUIRE(!fences.contain(100));
+
+    REQUIRE(stats::median(std::vector<double>()) == 0);
+    REQUIRE(stats::mad(std::vector<double>(3, 2.0)) == 0);
+}
+
+TEST_CASE("Distributions", "[statistics]")
+{
+    REQUIRE(stats::normal_cdf(0) == Approx(0.5));
+    REQUIRE(stats::normal_cdf(1.959964) == Approx(0.975).epsilon(1e-6));
+    REQUIRE(stats::normal_quantile(0.975) == Approx(1.959964).epsilon(1e-6));
+    REQUIRE(stats::normal_quantile(0.5) == Approx(0).epsilon(1e-9));
+
+    REQUIRE(stats::student_t_p_value(2.0, 10) == Approx(0.07339).epsilon(1e-3));
+    REQUIRE(stats::student_t_p_value(0, 5) == Approx(1));
+    REQUIRE(stats::student_t_p_value(2.228, 10) == Approx(0.05).epsilon(1e-3));
+}
+
+TEST_CASE("Welch's t-test", "[statistics]")
+{
+    std::vector<double> a = { 27.5, 21.0, 19.0, 23.6, 17.0, 17.9, 16.9, 20.1, 21.9, 22.6, 23.1, 19.6, 19.0, 21.7, 21.4 };
+    std::vector<double> b = { 27.1, 22.0, 20.8, 23.4, 23.4, 23.5, 25.8, 22.0, 24.8, 20.2, 21.9, 22.1, 22.9, 20.5, 24.4 };
+
+    auto test = stats::welch_test(a, b);
+    REQUIRE(test.statistic == Approx(-2.46).epsilon(0.01));
+    REQUIRE(test.p_value == Approx(0.021).epsilon(0.05));
+
+    SECTION("Identical samples")
+    {
+        auto same = stats::welch_test(a, a);
+        REQUIRE(same.statistic == Approx(0));
+        REQUIRE(same.p_value == Approx(1));
+    }
+}
+
+TEST_CASE("Mann-Whitney U test", "[statistics]")
+{
+    std::vector<double> low  = { 1, 2, 3, 4, 5, 6, 7, 8, 9, 10 };
+    std::vector<double> high = { 11, 12, 13, 14, 15, 16, 17, 18, 19, 20 };
+
+    auto test = stats::mann_whitney_test(low, high);
+    REQUIRE(test.statistic == 0);
+    REQUIRE(test.p_value < 0.001);
+
+    SECTION("Interleaved samples")
+    {
+        std::vector<double> odd  = { 1, 3, 5, 7, 9, 11, 13, 15, 17, 19 };
+        std::vector<double> even = { 2, 4, 6, 8, 10, 12, 14, 16, 18, 20 };
+        REQUIRE(stats::mann_whitney_test(odd, even).p_value > 0.5);
+    }
+
+    SECTION("Ties")
+    {
+        std::vector<double> same(10, 3.0);
+        auto tied = stats::mann_whitney_test(same, same);
+        REQUIRE(tied.statistic == Approx(50));
+        REQUIRE(tied.p_value == Approx(1));
+    }
+}
+
+static uint64_t spin(uint64_t rounds)
+{
+    uint64_t value = 1;
+    for (uint64_t i = 0; i < rounds; ++i)
+    {
+        value = value * 6364136223846793005ULL + 1442695040888963407ULL;
+        do_not_optimize(value);
+    }
+    return value;
+}
+
+TEST_CASE("Comparison", "[compare]")
+{
+    CompareOptions opts;
+    opts.batch_time = std::chrono::microseconds(200);
+    opts.samples = 20;
+
+    SECTION("Significant difference")
+    {
+        auto comparison = compare([]() { return spin(2000); }, []() { return spin(500); }, opts);
+
+        REQUIRE(comparison.a.size() == 20);
+        REQUIRE(comparison.b.size() == 20);
+        REQUIRE(comparison.speedup > 2);
+        REQUIRE(comparison.lower <= comparison.speedup);
+        REQUIRE(comparison.upper >= comparison.speedup);
+        REQUIRE(comparison.significant());
+    }
+
+    SECTION("Welch's t-test")
+    {
+        opts.test = CompareOptions::Test::welch;
+        auto comparison = compare([]() { return spin(500); }, []() { return spin(2000); }, opts);
+
+        REQUIRE(comparison.speedup < 0.5);
+        REQUIRE(comparison.significant());
+    }
+}
+
+TEST_CASE("Fast random numbers", "[statistics][random]")
+{
+    Xoshiro256 a(1), b(1), c(1);
+    c.jump();
+    auto first = a();
+    REQUIRE(first == b());
+    REQUIRE(first != c());
+
+    std::vector<int> counts(11, 0);
+    for (int i = 0; i < 100000; ++i)
+    {
+        ++counts[(std::min)(bounded(a, 10), 10u)];
+    }
+    REQUIRE(counts.back() == 0);
+    counts.pop_back();
+    for (auto count : counts)
+    {
+        REQUIRE(count > 9000);
+        REQUIRE(count < 11000);
+    }
+}
+
+TEST_CASE("Bootstrap budget", "[statistics][bootstrap]")
+{
+    // 10k resamples of 100k samples, well under a second per quantile
+    Xoshiro256 engine(5);
+    std::exponential_distribution<double> exponential(0.01);
+    std::vector<double> samples(100000);
+    for (auto& sample : samples) sample = exponential(engine);
+
+    stats::BootstrapOptions opts;
+    opts.resamples = 10000;
+
+    for (double percent : { 50.0, 99.0 })
+    {
+        auto before = std::chrono::steady_clock::now();
+        auto estimate = stats::bootstrap_percentile(samples, percent, opts);
+        auto elapsed = std::chrono::steady_clock::now() - before;
+
+        REQUIRE(estimate.lower < estimate.value);
+        REQUIRE(estimate.upper > estimate.value);
+        REQUIRE(elapsed < std::chrono::seconds(1));
+    }
+}
+
+TEST_CASE("Batched random numbers", "[statistics][random]")
+{
+    Xoshiro256 streams[] = { Xoshiro256(5), Xoshiro256(5), Xoshiro256(5), Xoshiro256(5) };
+    for (size_t lane = 1; lane < 4; ++lane)
+    {
+        for (size_t jumps = 0; jumps < lane; ++jumps) streams[lane].jump();
+    }
+
+    std::vector<uint64_t> expected(1026);
+    for (size_t i = 0; i < expected.size(); ++i)
+    {
+        expected[i] = streams[i % 4]();
+    }
+
+    SECTION("Scalar")
+    {
+        Xoshiro256x4 engine(5);
+        std::vector<uint64_t> values(1026);
+        engine.fill(values.data(), values.size(), simd::Isa::scalar);
+        REQUIRE(values == expected);
+    }
+
+    SECTION("AVX2")
+    {
+        if (!simd::supported(simd::Isa::avx2)) return;
+
+        Xoshiro256x4 engine(5);
+        std::vector<uint64_t> values(1026);
+        engine.fill(values.data(), values.size(), simd::Isa::avx2);
+        REQUIRE(values == expected);
+    }
+
+    SECTION("Generator")
+    {
+        Xoshiro256x4 engine(5);
+        for (size_t i = 0; i < 512; ++i)
+        {
+            REQUIRE(engine() == expected[i]);
+        }
+    }
+}
+
+TEST_CASE("Bootstrap confidence intervals", "[statistics][bootstrap]")
+{
+    Xoshiro256 engine(3);
+    std::normal_distribution<double> normal(100, 10);
+    std::exponential_distribution<double> exponential(0.01);
+
+    std::vector<double> samples(200);
+    for (auto& sample : samples) sample = normal(engine);
+
+    stats::BootstrapOptions opts;
+    opts.threads = 4;
+
+    SECTION("Mean")
+    {
+        auto estimate = stats::bootstrap_mean(samples, opts);
+        REQUIRE(estimate.value == Approx(stats::mean(samples)));
+        REQUIRE(estimate.lower < estimate.value);
+        REQUIRE(estimate.upper > estimate.value);
+
+        // About 1.96 standard errors on either side
+        auto width = estimate.upper - estimate.lower;
+        auto expected = 2 * 1.96 * stats::stddev(samples) / std::sqrt(200.0);
+        REQUIRE(width > 0.75 * expected);
+        REQUIRE(width < 1.25 * expected);
+    }
+
+    SECTION("Median and p99")
+    {
+        for (auto& sample : samples) sample = exponential(engine);
+
+        auto median = stats::bootstrap_median(samples, opts);
+        REQUIRE(median.value == Approx(stats::median(samples)));
+        REQUIRE(median.lower <= median.value);
+        REQUIRE(median.upper >= median.value);
+
+        auto p99 = stats::bootstrap_percentile(samples, 99, opts);
+        REQUIRE(p99.value == Approx(stats::quantile(samples, 0.99)));
+        REQUIRE(p99.lower <= p99.value);
+        REQUIRE(p99.upper >= p99.value);
+        REQUIRE(p99.lower > median.upper);
+    }
+
+    SECTION("Reproducible")
+    {
+        auto first = stats::bootstrap_median(samples, opts);
+        auto second = stats::bootstrap_median(samples, opts);
+        REQUIRE(first.lower == second.lower);
+        REQUIRE(first.upper == second.upper);
+    }
+
+    SECTION("Grouped jackknife")
+    {
+        opts.max_jackknife = 20;
+        auto estimate = stats::bootstrap_mean(samples, opts);
+        REQUIRE(estimate.lower < estimate.value);
+        REQUIRE(estimate.upper > estimate.value);
+    }
+
+    SECTION("Degenerate samples")
+    {
+        auto estimate = stats::bootstrap_mean(std::vector<double>(50, 7.0), opts);
+        REQUIRE(estimate.lower == 7.0);
+        REQUIRE(estimate.upper == 7.0);
+
+        REQUIRE(stats::bootstrap_mean(std::vector<double>(), opts).value == 0);
+    }
+
+    SECTION("Quantiles from resampled ranks")
+    {
+        for (auto& sample : samples) sample = exponential(engine);
+        opts.resamples = 4000;
+
+        for (double q : { 0.1, 0.5, 0.9 })
+        {
+            // The same interval, within the noise, as gathering every resample
+            stats::Quantile quantile = { q };
+            auto gathered = stats::bootstrap(samples, [quantile](std::vector<double>& resample) {
+                return quantile(resample);
+            }, opts);
+            auto counted = stats::bootstrap(samples, quantile, opts);
+
+            auto width = gathered.upper - gathered.lower;
+            REQUIRE(counted.value == Approx(gathered.value));
+            REQUIRE(std::abs(counted.lower - gathered.lower) < 0.2 * width);
+            REQUIRE(std::abs(counted.upper - gathered.upper) < 0.2 * width);
+        }
+    }
+
+    SECTION("Quantiles without sorting")
+    {
+        for (double q : { 0.0, 0.1, 0.5, 0.99, 1.0 })
+        {
+            auto copy = samples;
+            stats::Quantile quantile = { q };
+            REQUIRE(quantile(copy) == Approx(stats::quantile(samples, q)));
+        }
+    }
+}
@@ -0,0 +1,104 @@
+/*
+ *  Copyright 2016-present Daniel Trugman
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+
+#include "catch.hpp"
+
+#include <sstream>
+#include <string>
+#include <random>
+#include <vector>
+
+#include "random.hpp"
+#include "../sample/words.hpp"
+
+using namespace std;
+using namespace bm;
+
+// The words std::istream >> std::string finds, which WordCounter imitates
+static size_t extracted(const string& text)
+{
+    istringstream in(text);
+    size_t words = 0;
+    string word;
+    while (in >> word) ++words;
+    return words;
+}
+
+static size_t counted(WordCounter::Kernel kernel, const string& text, const vector<size_t>& splits)
+{
+    WordCounter counter(kernel);
+    size_t begin = 0;
+    for (auto end : splits)
+    {
+        counter.feed(text.data() + begin, end - begin);
+        begin = end;
+    }
+    counter.feed(text.data() + begin, text.size() - begin);
+    return counter.words();
+}
+
+TEST_CASE("Word counting kernels", "[words]")
+{
+    Xoshiro256 engine(7);
+    const WordCounter::Kernel kernels[] = {
+        WordCounter::Kernel::scalar, WordCounter::Kernel::sse2, WordCounter::Kernel::avx2 };
+
+    SECTION("Whitespace")
+    {
+        for (auto kernel : kernels)
+        {
+            if (!WordCounter::supported(kernel)) continue;
+
+            REQUIRE(counted(kernel, "", {}) == 0);
+            REQUIRE(counted(kernel, string(100, ' '), {}) == 0);
+            REQUIRE(counted(kernel, "a\tb\nc\vd\fe\rf g", {}) == 7);
+            REQUIRE(counted(kernel, "\x80\xff \x01 \x1f\x7f", {}) == 3);
+        }
+    }
+
+    SECTION("Random bytes split at random offsets")
+    {
+        // Mostly bytes around the whitespace range, and any byte at all
+        std::uniform_int_distribution<int> small(0, 40);
+        std::uniform_int_distribution<int> any(0, 255);
+        for (int round = 0; round < 200; ++round)
+        {
+            string text(bounded(engine, 1000), '\0');
+            for (auto& c : text)
+            {
+                c = static_cast<char>(bounded(engine, 2) ? small(engine) : any(engine));
+            }
+
+            vector<size_t> splits;
+            for (size_t offset = bounded(engine, 130); offset < text.size(); offset += bounded(engine, 130))
+            {
+                splits.push_back(offset);
+            }
+
+            auto expected = extracted(text);
+            for (auto kernel : kernels)
+            {
+                if (!WordCounter::supported(kernel)) continue;
+
+                INFO(WordCounter::to_string(kernel) << " over " << text.size() << " bytes in "
+                     << splits.size() + 1 << " chunks");
+                REQUIRE(counted(kernel, text, splits) == expected);
+                REQUIRE(counted(kernel, text, {}) == expected);
+            }
+        }
+    }
+}